@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * mpmc.c - Implementation of bounded multi-producer multi-consumer queue
+ *
+ * Slot at position p of a queue of capacity c cycles its sequence number:
+ *  seq == p        - free, the producer of position p may fill it
+ *  seq == p + 1    - filled, the consumer of position p may empty it
+ *  seq == p + c    - emptied, free for the producer of position p + c
+ * A producer claims position p by advancing enqueue_pos from p with CAS
+ * only after seeing seq == p, so it never waits on a slot being emptied;
+ * consumers do the same on dequeue_pos.
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include "mpmc.h"
+
+extern mpmc_result mpmc_init(mpmc *q, void *slots, size_t capacity,
+        size_t stride) {
+    size_t i;
+
+    // Slots are addressed by mask and shift, which only powers of two allow
+    if (0 == capacity || 0 != (capacity & (capacity - 1))
+            || stride < sizeof(mpmc_slot) || 0 != (stride & (stride - 1))) {
+        return MPMC_RET_ERROR;
+    }
+
+    q->slots = (char *) slots - (char *) q;
+    q->mask = capacity - 1;
+    q->shift = 0;
+    while (((size_t) 1 << q->shift) < stride) {
+        q->shift++;
+    }
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+
+    for (i = 0; i < capacity; i++) {
+        mpmc_slot_at(q, i)->seq = i;
+    }
+
+    return MPMC_RET_SUCCESS;
+}
+
+extern mpmc_result mpmc_push(mpmc *q, void *data) {
+    size_t pos = __atomic_load_n(&(q->enqueue_pos), __ATOMIC_RELAXED);
+    mpmc_slot *s;
+    ptrdiff_t dif;
+
+    while (1) {
+        s = mpmc_slot_at(q, pos);
+        dif = (ptrdiff_t) __atomic_load_n(&(s->seq), __ATOMIC_ACQUIRE)
+                - (ptrdiff_t) pos;
+        if (0 == dif) {
+            if (__atomic_compare_exchange_n(&(q->enqueue_pos), &pos, pos + 1,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return MPMC_RET_FAIL;
+        } else {
+            pos = __atomic_load_n(&(q->enqueue_pos), __ATOMIC_RELAXED);
+        }
+    }
+
+    s->data = data;
+    __atomic_store_n(&(s->seq), pos + 1, __ATOMIC_RELEASE);
+
+    return MPMC_RET_SUCCESS;
+}
+
+extern mpmc_result mpmc_pop(mpmc *q, void **data) {
+    size_t pos = __atomic_load_n(&(q->dequeue_pos), __ATOMIC_RELAXED);
+    mpmc_slot *s;
+    ptrdiff_t dif;
+
+    while (1) {
+        s = mpmc_slot_at(q, pos);
+        dif = (ptrdiff_t) __atomic_load_n(&(s->seq), __ATOMIC_ACQUIRE)
+                - (ptrdiff_t) (pos + 1);
+        if (0 == dif) {
+            if (__atomic_compare_exchange_n(&(q->dequeue_pos), &pos, pos + 1,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return MPMC_RET_FAIL;
+        } else {
+            pos = __atomic_load_n(&(q->dequeue_pos), __ATOMIC_RELAXED);
+        }
+    }
+
+    *data = s->data;
+    __atomic_store_n(&(s->seq), pos + q->mask + 1, __ATOMIC_RELEASE);
+
+    return MPMC_RET_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * mpmc.h - Bounded multi-producer multi-consumer queue and its operations
+ *
+ *   Description: Array based queue in which every slot carries a sequence
+ *                number telling whether it is free for the producer of a
+ *                position or filled for its consumer, so that producers and
+ *                consumers only contend on their own position counter.
+ *                Slots are addressed by offset from the queue, so the queue
+ *                is position independent as rounded double-linked list.
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#ifndef MPMC_H_
+#define MPMC_H_
+#include <stddef.h>
+
+/*
+ * Size of cache line, on which positions of the queue are separated
+ */
+#define MPMC_CACHE_LINE             64
+
+/*
+ * Result of queue operations
+ */
+typedef enum mpmc_result {
+    MPMC_RET_SUCCESS            = 0,
+    MPMC_RET_FAIL               = -1,   // Queue full or empty
+    MPMC_RET_ERROR              = -2    // Invalid argument
+} mpmc_result;
+
+/*
+ * Slot of queue
+ */
+typedef struct mpmc_slot {
+    size_t                      seq;
+    void*                       data;
+} mpmc_slot;
+
+/*
+ * Bounded multi-producer multi-consumer queue
+ */
+typedef struct mpmc {
+    ptrdiff_t                   slots;  // Offset of slots from the queue
+    size_t                      mask;   // Capacity - 1
+    int                         shift;  // Log2 of slot stride
+    size_t                      enqueue_pos
+                                __attribute__((aligned(MPMC_CACHE_LINE)));
+    size_t                      dequeue_pos
+                                __attribute__((aligned(MPMC_CACHE_LINE)));
+} mpmc;
+
+/*
+ * Slot of queue at position
+ * Parameters:  q   - The queue
+ *              pos - Position
+ */
+#define mpmc_slot_at(q, pos)       ((mpmc_slot *) ((char *) (q)            \
+                                        + (q)->slots                        \
+                                        + (((pos) & (q)->mask)              \
+                                            << (q)->shift)))
+
+/*
+ * To test if queue is empty
+ * Parameters:  q   - The queue
+ */
+#define mpmc_empty(q)              (                                       \
+                                        __atomic_load_n(&((q)->dequeue_pos),\
+                                                __ATOMIC_ACQUIRE)           \
+                                        ==                                  \
+                                        __atomic_load_n(&((q)->enqueue_pos),\
+                                                __ATOMIC_ACQUIRE)           \
+                                    )
+
+/*
+ * To test if queue is full
+ * Parameters:  q   - The queue
+ */
+#define mpmc_full(q)               (                                       \
+                                        __atomic_load_n(&((q)->enqueue_pos),\
+                                                __ATOMIC_ACQUIRE)           \
+                                        -                                   \
+                                        __atomic_load_n(&((q)->dequeue_pos),\
+                                                __ATOMIC_ACQUIRE)           \
+                                        > (q)->mask                         \
+                                    )
+
+/*
+ *  Description: Initialize a queue on slots following it in memory.
+ *    Parameter: q        - Queue.
+ *               slots    - Memory of slots.
+ *               capacity - Number of slots, a power of two.
+ *               stride   - Bytes per slot, a power of two not less than
+ *                          sizeof(mpmc_slot).
+ * Return value: On success returns MPMC_RET_SUCCESS;
+ *               if capacity or stride is not as above, it returns
+ *               MPMC_RET_ERROR with queue left uninitialized.
+ */
+extern mpmc_result mpmc_init(mpmc *q, void *slots, size_t capacity,
+        size_t stride);
+
+/*
+ *  Description: Add data to the tail of queue.
+ *    Parameter: q    - Queue.
+ *               data - Data to add.
+ * Return value: On success returns MPMC_RET_SUCCESS;
+ *               if queue is full, it returns MPMC_RET_FAIL.
+ */
+extern mpmc_result mpmc_push(mpmc *q, void *data);
+
+/*
+ *  Description: Remove data from the head of queue.
+ *    Parameter: q    - Queue.
+ *               data - Data removed.
+ * Return value: On success returns MPMC_RET_SUCCESS;
+ *               if queue is empty, it returns MPMC_RET_FAIL.
+ */
+extern mpmc_result mpmc_pop(mpmc *q, void **data);
+
+#endif /* MPMC_H_ */
@@ -1,6 +1,15 @@
 /*****************************************************************************
  * paralexeclist.c - Implementation of parallel execution list
  *
+ * Parking: every side of the list (enrolled and idle) has a futex word which
+ * is bumped after each add, and a count of parked threads. A waiter announces
+ * itself before sampling the word and re-testing the list, so an add either
+ * is seen by the re-test or sees the waiter and wakes it:
+ *  |       Waiter          |       Adder           |
+ *  |  waiters++            |  rdl_add(e)           |
+ *  |  s = seq              |  seq++                |
+ *  |  if (empty)           |  if (waiters)         |
+ *  |    futex_wait(seq, s) |    futex_wake(seq, 1) |
  *
  *    Created on: Oct 16, 2012
  *        Author: Kurt Zhi
@@ -8,109 +17,2741 @@
  *      Web site: www.kurtzhi.com
  *****************************************************************************/
 
+#define _GNU_SOURCE
+#include <limits.h>
+#include <sched.h>
 #include <stdlib.h>
-#include "rdl.h"
-#include "paralexeclist.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/mempolicy.h>
+#include "paralexeclist_internal.h"
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE         23
+#endif
+
+/*
+ * Time left until deadline, returns -1 when it has passed.
+ */
+static int paralexeclist_remain(const struct timespec *deadline,
+        struct timespec *remain) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    remain->tv_sec = deadline->tv_sec - now.tv_sec;
+    remain->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (remain->tv_nsec < 0) {
+        remain->tv_sec--;
+        remain->tv_nsec += 1000000000L;
+    }
+
+    return remain->tv_sec < 0 ? -1 : 0;
+}
+
+extern void paralexeclist_waiter_init(paralexeclist_waiter *w, int timeout_ms,
+        const int *cancel) {
+    w->timeout_ms = timeout_ms;
+    w->tries = 0;
+    w->cancel = cancel;
+
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &(w->deadline));
+        w->deadline.tv_sec += timeout_ms / 1000;
+        w->deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (w->deadline.tv_nsec >= 1000000000L) {
+            w->deadline.tv_sec++;
+            w->deadline.tv_nsec -= 1000000000L;
+        }
+    }
+}
+
+/*
+ * To test if waiter was cancelled.
+ */
+static inline int paralexeclist_cancelled(paralexeclist_waiter *w) {
+    return w->cancel && __atomic_load_n(w->cancel, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Decide what to do after a side of the list was found empty. Returns
+ * PARALEXECLIST_RET_EMPTY or PARALEXECLIST_RET_TIMEOUT to give up,
+ * PARALEXECLIST_WAIT_PARK to park, or 0 to retry at once.
+ */
+static int paralexeclist_waiter_next(paralexeclist *plt,
+        paralexeclist_waiter *w) {
+    if (0 == w->timeout_ms || paralexeclist_cancelled(w)) {
+        return PARALEXECLIST_RET_EMPTY;
+    }
+    if (w->timeout_ms > 0
+            && 0 != paralexeclist_remain(&(w->deadline), &(w->remain))) {
+        return PARALEXECLIST_RET_TIMEOUT;
+    }
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_PARK)
+            || ++(w->tries) < PARALEXECLIST_SPIN_TRIES) {
+        return 0;
+    }
+
+    w->tries = 0;
+    return PARALEXECLIST_WAIT_PARK;
+}
+
+/*
+ * Announce a waiter on the event, returning the futex word to sleep on. The
+ * caller re-tests the side of the list before paralexeclist_park.
+ */
+static inline unsigned int paralexeclist_park_prepare(
+        paralexeclist_event *ev) {
+    __atomic_add_fetch(&(ev->waiters), 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&(ev->seq), __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Sleep on the event for up to timeout, or for ever if 0, unless the side
+ * of the list turned non-empty or the waiter was cancelled, and withdraw
+ * the waiter.
+ */
+static inline void paralexeclist_park(paralexeclist_event *ev,
+        unsigned int seq, int empty, paralexeclist_waiter *w,
+        const struct timespec *timeout) {
+    if (empty && !paralexeclist_cancelled(w)) {
+        paralexeclist_futex(&(ev->seq), FUTEX_WAIT, seq, timeout);
+    }
+    __atomic_sub_fetch(&(ev->waiters), 1, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Thread index, small and unique per thread of the process
+ */
+static int paralexeclist_thread_next;
+static __thread int paralexeclist_thread_index = -1;
+
+static inline int paralexeclist_thread(void) {
+    if (paralexeclist_thread_index < 0) {
+        paralexeclist_thread_index = __atomic_fetch_add(
+                &paralexeclist_thread_next, 1, __ATOMIC_RELAXED);
+    }
+    return paralexeclist_thread_index;
+}
+
+/*
+ * Enrolled shard local to the calling thread, the one of its CPU.
+ */
+static inline int paralexeclist_local_shard(paralexeclist *plt) {
+    if (1 == plt->shards) {
+        return 0;
+    }
+
+    int cpu = sched_getcpu();
+    return (cpu < 0 ? paralexeclist_thread() : cpu) % plt->shards;
+}
+
+/*
+ * Idle pool local to the calling thread, the one of the node of its CPU.
+ */
+static inline int paralexeclist_local_node(paralexeclist *plt) {
+    unsigned int cpu, node;
+
+    if (1 == plt->nodes || 0 != getcpu(&cpu, &node)) {
+        return 0;
+    }
+    return node % plt->nodes;
+}
+
+/*
+ * Idle pool an element belongs to, the one of the node holding its memory.
+ */
+static inline int paralexeclist_node_of(paralexeclist *plt, rdl_element *e) {
+    paralexeclist_shared *sh = plt->shared;
+
+    if (1 == plt->nodes) {
+        return 0;
+    }
+    return ((char *) e - (char *) sh - sh->elmts) / sh->pool_len;
+}
+
+/*
+ * Counter slot of the calling thread, or 0 if list does not count.
+ */
+static inline paralexeclist_stats_slot *paralexeclist_stats_slot_of(
+        paralexeclist *plt) {
+    return plt->stats ? &(plt->stats[paralexeclist_thread()
+            % PARALEXECLIST_STATS_SLOTS]) : 0;
+}
+
+/*
+ * Data enrolled, summed over counter slots.
+ */
+static unsigned long paralexeclist_stats_depth(
+        paralexeclist_stats_slot *slots) {
+    long depth = 0;
+    int i;
+
+    for (i = 0; i < PARALEXECLIST_STATS_SLOTS; i++) {
+        depth += __atomic_load_n(&(slots[i].produced), __ATOMIC_RELAXED);
+        depth -= __atomic_load_n(&(slots[i].consumed), __ATOMIC_RELAXED);
+    }
+    return depth > 0 ? depth : 0;   // Slots are not read at once
+}
+
+static __thread unsigned int paralexeclist_stats_tick;
+
+/*
+ * Add counters of an operation to the slot of the calling thread, and
+ * sample depth every PARALEXECLIST_STATS_SAMPLE operations of the thread.
+ */
+static void paralexeclist_stats_add(paralexeclist *plt, const rdl_stats *st,
+        unsigned long retries, unsigned long produced,
+        unsigned long consumed) {
+    paralexeclist_stats_slot *slot = paralexeclist_stats_slot_of(plt);
+    unsigned long depth, max;
+
+#define paralexeclist_stats_inc(f, n)   ({                                  \
+            if (n) {                                                        \
+                __atomic_fetch_add(&(slot->f), (n), __ATOMIC_RELAXED);      \
+            }                                                               \
+        })
+    paralexeclist_stats_inc(produced, produced);
+    paralexeclist_stats_inc(consumed, consumed);
+    paralexeclist_stats_inc(retries, retries);
+    if (st) {
+        paralexeclist_stats_inc(rdl.trylock_fail_next, st->trylock_fail_next);
+        paralexeclist_stats_inc(rdl.trylock_fail_prev, st->trylock_fail_prev);
+        paralexeclist_stats_inc(rdl.trylock_fail_elmt, st->trylock_fail_elmt);
+        paralexeclist_stats_inc(rdl.walked, st->walked);
+    }
+#undef paralexeclist_stats_inc
+
+    if ((produced || consumed) && 0 == ++paralexeclist_stats_tick
+            % PARALEXECLIST_STATS_SAMPLE) {
+        depth = paralexeclist_stats_depth(plt->stats);
+        max = __atomic_load_n(&(plt->shared->depth_max), __ATOMIC_RELAXED);
+        while (depth > max && !__atomic_compare_exchange_n(
+                &(plt->shared->depth_max), &max, depth, 1, __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+extern void paralexeclist_account(paralexeclist *plt, const rdl_stats *st,
+        unsigned long retries, unsigned long produced,
+        unsigned long consumed) {
+    unsigned long fails = st->trylock_fail_next + st->trylock_fail_prev
+            + st->trylock_fail_elmt;
+
+    if (plt->stats) {
+        paralexeclist_stats_add(plt, st, retries, produced, consumed);
+    }
+    if (retries || fails) {
+        paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_RETRY, fails,
+                retries);
+    }
+}
+
+/*
+ * To test if all lists of a side are empty.
+ */
+static inline int paralexeclist_empty(rdl **lists, int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        if (!rdl_empty(lists[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Decide if a consumer takes from the lowest lane with data first, as
+ * higher lanes had their quota.
+ */
+static inline int paralexeclist_lane_starved(paralexeclist *plt) {
+    paralexeclist_shared *sh = plt->shared;
+
+    if (__atomic_load_n(&(sh->prio_streak), __ATOMIC_RELAXED)
+            < sh->prio_quota) {
+        return 0;
+    }
+    __atomic_store_n(&(sh->prio_streak), 0, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/*
+ * Account data taken from lane, counting streak of higher lanes served
+ * while a lower one waits.
+ */
+static inline void paralexeclist_lane_taken(paralexeclist *plt, rdl **lists,
+        int n, int lane) {
+    paralexeclist_shared *sh = plt->shared;
+
+    if (!paralexeclist_empty(lists, n * lane)) {
+        __atomic_add_fetch(&(sh->prio_streak), 1, __ATOMIC_RELAXED);
+    } else if (__atomic_load_n(&(sh->prio_streak), __ATOMIC_RELAXED)) {
+        __atomic_store_n(&(sh->prio_streak), 0, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Eventfd: a thread enrolling data writes the eventfd unless it was written
+ * since the last drain, and a drain clears that before it takes data. So
+ * either the drain finds the data, or the enroller finds the flag cleared
+ * and writes the eventfd again:
+ *  |       Enroller                |       Drain                   |
+ *  |  enroll                       |  read(efd)                    |
+ *  |  fence                        |  notified = 0                 |
+ *  |  if (!xchg(notified, 1))      |  fence                        |
+ *  |    write(efd)                 |  take                         |
+ */
+static inline void paralexeclist_notify(paralexeclist *plt) {
+    unsigned int *notified = &(plt->shared->notified);
+
+    if (plt->efd < 0) {
+        return;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 == __atomic_load_n(notified, __ATOMIC_RELAXED)
+            && 0 == __atomic_exchange_n(notified, 1, __ATOMIC_SEQ_CST)) {
+        eventfd_write(plt->efd, 1);
+    }
+}
+
+static __thread unsigned int paralexeclist_key_next;
+static __thread unsigned int paralexeclist_key_turn;
+
+/*
+ * Give up a key slot claimed, and wake a consumer for data added to it
+ * meanwhile, which consumers passed by.
+ */
+static void paralexeclist_key_release(paralexeclist *plt,
+        paralexeclist_shard *key) {
+    __atomic_store_n(&(key->busy), 0, __ATOMIC_SEQ_CST);
+    if (rdl_empty(&(key->list))) {
+        return;
+    }
+    if (plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(plt->enrolled_ev, 1);
+    }
+    paralexeclist_notify(plt);
+}
+
+/*
+ * Release the key slot elements of owner were taken from, if any, once
+ * their data ran.
+ */
+static inline void paralexeclist_key_done(paralexeclist *plt, int owner) {
+    int k = owner - plt->key_base;
+
+    if (plt->keys && k >= 0 && k < plt->keys) {
+        paralexeclist_key_release(plt, &(plt->keyed[k]));
+    }
+}
+
+/*
+ * To test if a key slot with data is not claimed by a consumer.
+ */
+static int paralexeclist_key_ready(paralexeclist *plt) {
+    paralexeclist_shard *key;
+    int k;
+
+    if (0 == __atomic_load_n(&(plt->shared->keyed), __ATOMIC_SEQ_CST)) {
+        return 0;
+    }
+    for (k = 0; k < plt->keys; k++) {
+        key = &(plt->keyed[k]);
+        if (!rdl_empty(&(key->list))
+                && 0 == __atomic_load_n(&(key->busy), __ATOMIC_SEQ_CST)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Claim a key slot with data, scanning from the one after the last the
+ * thread looked at, and remove up to max elements of it, which the caller
+ * releases with paralexeclist_key_done. Returns RDL_RET_FAIL when no slot
+ * could be claimed.
+ */
+static rdl_result paralexeclist_key_take(paralexeclist *plt, int max,
+        rdl_element **first, rdl_element **last, int *count, rdl_stats *st,
+        rdl_backoff *bo) {
+    paralexeclist_shard *key;
+    rdl_result res;
+    int i, busy;
+
+    if (0 == __atomic_load_n(&(plt->shared->keyed), __ATOMIC_ACQUIRE)) {
+        return RDL_RET_FAIL;
+    }
+    for (i = 0; i < plt->keys; i++) {
+        key = &(plt->keyed[paralexeclist_key_next++ % plt->keys]);
+        busy = 0;
+        if (rdl_empty(&(key->list))
+                || 0 != __atomic_load_n(&(key->busy), __ATOMIC_RELAXED)
+                || !__atomic_compare_exchange_n(&(key->busy), &busy, 1, 0,
+                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        if (rdl_empty(&(key->list))) {
+            paralexeclist_key_release(plt, key);
+            continue;   // Emptied by the consumer which had it claimed
+        }
+
+        // Only the claimer removes, so the slot stays with data and the
+        // removal only fails on contention with producers
+        while (RDL_RET_FAIL == (res = 1 == max ? rdl_remove(&(key->list),
+                first, st, bo) : rdl_remove_n(&(key->list), max, first, last,
+                        count, st, bo))) {
+            rdl_backoff_wait(bo);
+        }
+        if (RDL_RET_SUCCESS == res) {
+            __atomic_sub_fetch(&(plt->shared->keyed), 1 == max ? 1 : *count,
+                    __ATOMIC_RELAXED);
+        } else {
+            paralexeclist_key_release(plt, key);
+        }
+        return res;
+    }
+
+    return RDL_RET_FAIL;
+}
+
+/*
+ * Exchange: a producer announces itself on a free slot and spins on it; a
+ * consumer giving back one element swaps it in for the announcement. The
+ * producer withdraws with the reverse swap, so exactly one of the two
+ * wins a slot it waited on:
+ *  |       Producer                |       Consumer                |
+ *  |  cas(slot, FREE, WAITING)     |                               |
+ *  |  spin while slot == WAITING   |  cas(slot, WAITING, e)        |
+ *  |  cas(slot, WAITING, FREE)     |                               |
+ *  |  or take e, slot = FREE       |                               |
+ */
+
+/*
+ * Wait a moment on the exchange slot of the calling thread for an element
+ * a consumer hands over. Returns 0 with the element in e, or -1 if the
+ * slot was taken or no element came.
+ */
+static int paralexeclist_exchange_take(paralexeclist *plt, rdl_element **e) {
+    paralexeclist_exchange *x = &(plt->shared->exchange[paralexeclist_thread()
+            % PARALEXECLIST_EXCHANGE_SLOTS]);
+    ptrdiff_t v = PARALEXECLIST_EXCHANGE_FREE;
+    int i;
+
+    if (!__atomic_compare_exchange_n(&(x->slot), &v,
+            PARALEXECLIST_EXCHANGE_WAITING, 0, __ATOMIC_ACQ_REL,
+            __ATOMIC_RELAXED)) {
+        return -1;
+    }
+
+    for (i = 0; i < PARALEXECLIST_EXCHANGE_SPINS; i++) {
+        if (PARALEXECLIST_EXCHANGE_WAITING != (v = __atomic_load_n(
+                &(x->slot), __ATOMIC_ACQUIRE))) {
+            break;
+        }
+        rdl_cpu_relax();
+    }
+    if (PARALEXECLIST_EXCHANGE_WAITING == v && __atomic_compare_exchange_n(
+            &(x->slot), &v, PARALEXECLIST_EXCHANGE_FREE, 0, __ATOMIC_ACQUIRE,
+            __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    // v holds the element, handed over before the withdrawal if it failed
+    __atomic_store_n(&(x->slot), PARALEXECLIST_EXCHANGE_FREE,
+            __ATOMIC_RELEASE);
+    *e = (rdl_element *) ((char *) plt->shared + v);
+    return 0;
+}
+
+/*
+ * Hand an element given back to idle to a producer waiting on an exchange
+ * slot, from the slot of the calling thread on. Returns 0 once handed, or
+ * -1 if no producer waits. Elements are not handed while a segment of an
+ * elastic list retires, so they come back through idle to be collected.
+ */
+static int paralexeclist_exchange_give(paralexeclist *plt, rdl_element *e) {
+    paralexeclist_exchange *x = plt->shared->exchange;
+    paralexeclist_stats_slot *slot;
+    ptrdiff_t v;
+    int i, j;
+
+    if (plt->elastic && __atomic_load_n(&(plt->elastic->retiring),
+            __ATOMIC_RELAXED)) {
+        return -1;
+    }
+
+    for (i = 0, j = paralexeclist_thread() % PARALEXECLIST_EXCHANGE_SLOTS;
+            i < PARALEXECLIST_EXCHANGE_SLOTS;
+            i++, j = (j + 1) % PARALEXECLIST_EXCHANGE_SLOTS) {
+        v = PARALEXECLIST_EXCHANGE_WAITING;
+        if (v == __atomic_load_n(&(x[j].slot), __ATOMIC_RELAXED)
+                && __atomic_compare_exchange_n(&(x[j].slot), &v,
+                        (char *) e - (char *) plt->shared, 0,
+                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            if ((slot = paralexeclist_stats_slot_of(plt))) {
+                __atomic_fetch_add(&(slot->exchanged), 1, __ATOMIC_RELAXED);
+                paralexeclist_stats_add(plt, 0, 0, 0, 1);
+            }
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Timer wheel: a thread filing data reads the tick, files them in the slot
+ * of their due tick as seen from it, then reads the tick again; a thread
+ * turning the wheel stores each tick before it visits the slots of it. So
+ * either the visit finds data filed, or the filer finds the slot may have
+ * been visited, and visits it itself:
+ *  |       Filer                   |       Turner                  |
+ *  |  c = tick                     |  tick = t                     |
+ *  |  add(slot(due, c))            |  fence                        |
+ *  |  fence                        |  visit(slots of t)            |
+ *  |  if (tick >= visit(due, c))   |                               |
+ *  |    visit(slot(due, c))        |                               |
+ */
+static int paralexeclist_give(paralexeclist *plt, rdl *rdl,
+        paralexeclist_event *ev, rdl_element *first, rdl_element *last,
+        int count);
+
+static inline unsigned long paralexeclist_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000UL + now.tv_nsec / 1000000L;
+}
+
+/*
+ * Slot to file data due at tick due in, while the wheel is at tick cur
+ * before it, returns the tick the slot is visited at. Data due beyond the
+ * top level go to its slot visited last, and are filed again from there.
+ */
+static unsigned long paralexeclist_wheel_slot(unsigned long due,
+        unsigned long cur, int *slot) {
+    int l, shift;
+
+    for (l = 0; l < PARALEXECLIST_WHEEL_LEVELS; l++) {
+        shift = PARALEXECLIST_WHEEL_BITS * l;
+        if (due >> (shift + PARALEXECLIST_WHEEL_BITS)
+                == cur >> (shift + PARALEXECLIST_WHEEL_BITS)) {
+            *slot = l * PARALEXECLIST_WHEEL_SLOTS + ((due >> shift)
+                    & (PARALEXECLIST_WHEEL_SLOTS - 1));
+            return (due >> shift) << shift;
+        }
+    }
+
+    l = PARALEXECLIST_WHEEL_LEVELS - 1;
+    shift = PARALEXECLIST_WHEEL_BITS * l;
+    *slot = l * PARALEXECLIST_WHEEL_SLOTS + (((cur >> shift)
+            + PARALEXECLIST_WHEEL_SLOTS - 1) & (PARALEXECLIST_WHEEL_SLOTS - 1));
+    return ((cur >> shift) + PARALEXECLIST_WHEEL_SLOTS - 1) << shift;
+}
+
+static int paralexeclist_wheel_visit(paralexeclist *plt, int slot,
+        unsigned long t);
+
+/*
+ * File an element in the wheel to be enrolled at tick due, or enroll it at
+ * once if it is due.
+ */
+static int paralexeclist_wheel_file(paralexeclist *plt, rdl_element *e,
+        unsigned long due) {
+    paralexeclist_wheel *wh = &(plt->shared->wheel);
+    unsigned long cur = __atomic_load_n(&(wh->tick), __ATOMIC_SEQ_CST);
+    unsigned long at, next;
+    rdl_backoff bo;
+    rdl_result res;
+    int slot, parity = 0;
+
+    if (due <= cur) {
+        return paralexeclist_give(plt,
+                plt->enrolled[paralexeclist_local_shard(plt)],
+                plt->enrolled_ev, e, e, 1);
+    }
+
+    at = paralexeclist_wheel_slot(due, cur, &slot);
+    *paralexeclist_due_of(plt, e) = due;
+    __atomic_add_fetch(&(wh->count), 1, __ATOMIC_SEQ_CST);
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    if (plt->elastic) {
+        parity = paralexeclist_elastic_enter(plt->elastic);
+    }
+    while (RDL_RET_FAIL == (res = rdl_add(&(plt->wheel[slot].list), e, 0,
+            &bo))) {
+        rdl_backoff_wait(&bo);
+    }
+    if (plt->elastic) {
+        paralexeclist_elastic_leave(plt->elastic, parity);
+    }
+    if (RDL_RET_ERROR == res) {
+        __atomic_sub_fetch(&(wh->count), 1, __ATOMIC_SEQ_CST);
+        return -1;
+    }
+
+    // A consumer parked until a later tick wakes to park until this one
+    next = __atomic_load_n(&(wh->next), __ATOMIC_SEQ_CST);
+    while (at < next && !__atomic_compare_exchange_n(&(wh->next), &next, at,
+            0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    }
+    if (at < next && plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(plt->enrolled_ev, 1);
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if ((cur = __atomic_load_n(&(wh->tick), __ATOMIC_SEQ_CST)) >= at) {
+        return paralexeclist_wheel_visit(plt, slot, cur);
+    }
+
+    return 0;
+}
+
+/*
+ * Take the data out of a slot of the wheel, enroll those due at tick t by
+ * batch, and file the others again.
+ */
+static int paralexeclist_wheel_visit(paralexeclist *plt, int slot,
+        unsigned long t) {
+    paralexeclist_wheel *wh = &(plt->shared->wheel);
+    rdl *list = &(plt->wheel[slot].list);
+    rdl_element *first, *last, *e, *next, *kept;
+    unsigned long due;
+    rdl_backoff bo;
+    rdl_result res;
+    int count, i, n, parity = 0;
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    while (!rdl_empty(list)) {
+        if (plt->elastic) {
+            parity = paralexeclist_elastic_enter(plt->elastic);
+        }
+        res = rdl_remove_n(list, PARALEXECLIST_BATCH_MAX, &first, &last,
+                &count, 0, &bo);
+        if (plt->elastic) {
+            paralexeclist_elastic_leave(plt->elastic, parity);
+        }
+        if (RDL_RET_ERROR == res) {
+            return -1;
+        }
+        if (RDL_RET_FAIL == res) {
+            rdl_backoff_wait(&bo);
+            continue;
+        }
+        __atomic_sub_fetch(&(wh->count), count, __ATOMIC_SEQ_CST);
+
+        for (i = 0, n = 0, kept = 0, e = first; i < count; i++, e = next) {
+            next = rdl_next(e);
+            if ((due = *paralexeclist_due_of(plt, e)) > t) {
+                if (0 != paralexeclist_wheel_file(plt, e, due)) {
+                    return -1;
+                }
+                continue;
+            }
+            if (kept) {
+                rdl_set_next(kept, e);
+                rdl_set_prev(e, kept);
+            } else {
+                first = e;
+            }
+            kept = e;
+            n++;
+        }
+        if (n && 0 != paralexeclist_give(plt,
+                plt->enrolled[paralexeclist_local_shard(plt)],
+                plt->enrolled_ev, first, kept, n)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Turn the wheel up to now, visiting the slots of every tick passed, unless
+ * another thread turns it. With no data filed, the wheel only turns for a
+ * thread about to file, and jumps to now.
+ */
+static void paralexeclist_wheel_turn(paralexeclist *plt, int filing) {
+    paralexeclist_wheel *wh = &(plt->shared->wheel);
+    int count = __atomic_load_n(&(wh->count), __ATOMIC_SEQ_CST);
+    unsigned long now, t, next, at;
+    int unlocked = 0, l, shift;
+
+    if (0 == count && !filing) {
+        return;
+    }
+    now = paralexeclist_now_ms();
+    if ((count && now < __atomic_load_n(&(wh->next), __ATOMIC_SEQ_CST))
+            || now <= __atomic_load_n(&(wh->tick), __ATOMIC_RELAXED)
+            || !__atomic_compare_exchange_n(&(wh->lock), &unlocked, 1, 0,
+                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    for (t = wh->tick; t < now; ) {
+        if (0 == __atomic_load_n(&(wh->count), __ATOMIC_SEQ_CST)) {
+            t = now;
+            __atomic_store_n(&(wh->tick), t, __ATOMIC_SEQ_CST);
+            break;
+        }
+        __atomic_store_n(&(wh->tick), ++t, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        // Higher levels first, so that data they move down due at t are
+        // enrolled at once
+        for (l = PARALEXECLIST_WHEEL_LEVELS - 1; l > 0; l--) {
+            shift = PARALEXECLIST_WHEEL_BITS * l;
+            if (0 == (t & ((1UL << shift) - 1))) {
+                paralexeclist_wheel_visit(plt, l * PARALEXECLIST_WHEEL_SLOTS
+                        + ((t >> shift) & (PARALEXECLIST_WHEEL_SLOTS - 1)),
+                        t);
+            }
+        }
+        paralexeclist_wheel_visit(plt, t & (PARALEXECLIST_WHEEL_SLOTS - 1),
+                t);
+    }
+
+    // Next tick with a slot to visit: one of level 0 with data, or the
+    // next visit of level 1. Filers meanwhile lower it themselves.
+    __atomic_store_n(&(wh->next), ULONG_MAX, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    next = (t | (PARALEXECLIST_WHEEL_SLOTS - 1)) + 1;
+    for (at = t + 1; at < next; at++) {
+        if (!rdl_empty(&(plt->wheel[at & (PARALEXECLIST_WHEEL_SLOTS - 1)]
+                .list))) {
+            next = at;
+            break;
+        }
+    }
+    at = ULONG_MAX;
+    while (next < at && !__atomic_compare_exchange_n(&(wh->next), &at, next,
+            0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    }
+
+    __atomic_store_n(&(wh->lock), 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Time a consumer parks for at most, the one of its waiter or until the
+ * next tick of the wheel with a slot to visit while data are filed.
+ */
+static const struct timespec *paralexeclist_wheel_bound(paralexeclist *plt,
+        paralexeclist_waiter *w, struct timespec *until) {
+    paralexeclist_wheel *wh = &(plt->shared->wheel);
+    const struct timespec *tmo = w->timeout_ms > 0 ? &(w->remain) : 0;
+    unsigned long now, next;
+    long ms;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TIMERS)
+            || 0 == __atomic_load_n(&(wh->count), __ATOMIC_SEQ_CST)) {
+        return tmo;
+    }
+
+    now = paralexeclist_now_ms();
+    next = __atomic_load_n(&(wh->next), __ATOMIC_SEQ_CST);
+    ms = next > now ? (long) (next - now) : 1;
+    until->tv_sec = ms / 1000;
+    until->tv_nsec = ms % 1000 * 1000000L;
+    if (tmo && (tmo->tv_sec < until->tv_sec || (tmo->tv_sec
+            == until->tv_sec && tmo->tv_nsec < until->tv_nsec))) {
+        return tmo;
+    }
+    return until;
+}
+
+/*
+ * Remove up to max elements from a side of the list made of lanes of n
+ * lists, from the highest lane with data, starting at list start of a lane
+ * and stealing from the others when it is empty, and wait with waiter
+ * while all of them are empty. Consumers of enrolled take from key slots
+ * and from lanes in turn.
+ */
+static int paralexeclist_take(paralexeclist *plt, rdl **lists, int n,
+        int lanes, int start, paralexeclist_event *ev,
+        paralexeclist_waiter *w, int max, rdl_element **first,
+        rdl_element **last, int *count) {
+    rdl_stats st = {0, 0, 0, 0};
+    rdl_stats *pst = plt->stats || plt->flags & PARALEXECLIST_ATTR_TRACE
+            ? &st : 0;
+    unsigned long retries = 0;
+    rdl_element *e;
+    rdl_backoff bo;
+    rdl_result res;
+    unsigned int seq;
+    int ret, i, j, k, lane = 0, up = 0, parity = 0, keyed = 0, empty;
+    int keys = plt->keys && lists == plt->enrolled;
+    int exchange = plt->flags & PARALEXECLIST_ATTR_EXCHANGE && 1 == max
+            && lists == plt->idle;
+    int timers = plt->flags & PARALEXECLIST_ATTR_TIMERS
+            && lists == plt->enrolled;
+    struct timespec until;
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+
+    while (1) {
+        if (timers) {
+            paralexeclist_wheel_turn(plt, 0);
+        }
+        if (plt->elastic) {
+            parity = paralexeclist_elastic_enter(plt->elastic);
+        }
+        if (lanes > 1) {
+            up = paralexeclist_lane_starved(plt);
+        }
+        res = RDL_RET_FAIL;
+        keyed = 0;
+        if (keys && ++paralexeclist_key_turn & 1) {
+            keyed = RDL_RET_FAIL != (res = paralexeclist_key_take(plt, max,
+                    first, last, count, pst, &bo));
+        }
+        for (k = 0; k < lanes && RDL_RET_FAIL == res; k++) {
+            lane = up ? k : lanes - 1 - k;
+            for (i = 0, j = start; i < n; i++, j = j + 1 < n ? j + 1 : 0) {
+                res = 1 == max ? rdl_remove(lists[lane * n + j], first, pst,
+                        &bo) : rdl_remove_n(lists[lane * n + j], max, first,
+                                last, count, pst, &bo);
+                if (RDL_RET_FAIL != res) {
+                    break;
+                }
+            }
+        }
+        if (keys && RDL_RET_FAIL == res) {
+            keyed = RDL_RET_FAIL != (res = paralexeclist_key_take(plt, max,
+                    first, last, count, pst, &bo));
+        }
+        if (plt->elastic) {
+            paralexeclist_elastic_leave(plt->elastic, parity);
+        }
+        if (RDL_RET_SUCCESS == res && lanes > 1 && !keyed) {
+            paralexeclist_lane_taken(plt, lists, n, lane);
+        }
+        if (RDL_RET_SUCCESS == res && 1 == max) {
+            *last = *first;
+            *count = 1;
+        }
+        if (RDL_RET_SUCCESS == res && plt->elastic && lists == plt->idle) {
+            paralexeclist_elastic_filter(plt, first, last, count, 1);
+            if (0 == *count) {
+                continue;   // All of retiring segment
+            }
+        }
+        if (RDL_RET_FAIL != res) {
+            break;
+        }
+
+        empty = paralexeclist_empty(lists, n * lanes)
+                && !(keys && paralexeclist_key_ready(plt));
+        // Waiting on an exchange slot stands in for backoff, or for a try
+        // of a waiter which may wait
+        if (exchange && (!empty || 0 != w->timeout_ms)
+                && 0 == paralexeclist_exchange_take(plt, first)) {
+            *last = *first;
+            *count = 1;
+            res = RDL_RET_SUCCESS;
+            break;
+        }
+        if (!empty) {
+            retries++;
+            rdl_backoff_wait(&bo);
+            continue;   // Lost on contention
+        }
+        if (plt->elastic && lists == plt->idle
+                && 0 == paralexeclist_elastic_grow(plt)) {
+            continue;
+        }
+        if (PARALEXECLIST_WAIT_PARK != (ret = paralexeclist_waiter_next(plt,
+                w))) {
+            if (0 != ret) {
+                paralexeclist_account(plt, &st, retries, 0, 0);
+                return ret;
+            }
+            continue;
+        }
+
+        seq = paralexeclist_park_prepare(ev);
+        paralexeclist_park(ev, seq, paralexeclist_empty(lists, n * lanes)
+                && !(keys && paralexeclist_key_ready(plt)), w,
+                lists == plt->enrolled ? paralexeclist_wheel_bound(plt, w,
+                        &until) : w->timeout_ms > 0 ? &(w->remain) : 0);
+    }
+    paralexeclist_account(plt, &st, retries, 0, 0);
+    if (RDL_RET_ERROR == res) {
+        return -1;
+    }
+    if (lists == plt->enrolled && plt->flags & PARALEXECLIST_ATTR_TRACE) {
+        for (i = 0, e = *first; i < *count; i++, e = rdl_next(e)) {
+            paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_TAKE,
+                    (char *) e - (char *) plt->shared, 0);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Account data dropped to make room, handing it to the overflow routine.
+ */
+static void paralexeclist_overflowed(paralexeclist *plt, void *data) {
+    if (plt->stats) {
+        paralexeclist_stats_add(plt, 0, 0, 0, 1);
+    }
+    if (plt->overflow_routine) {
+        plt->overflow_routine(data);
+    }
+}
+
+/*
+ * Add data to the ring, applying overflow policy while it is full.
+ */
+static int paralexeclist_ring_put(paralexeclist *plt, void *data,
+        int overflow, int timeout_ms) {
+    mpmc *q = &(plt->shared->ring);
+    paralexeclist_waiter w;
+    unsigned long retries = 0;
+    unsigned int seq;
+    rdl_backoff bo;
+    void *oldest;
+    int ret;
+
+    paralexeclist_waiter_init(&w, PARALEXECLIST_OVERFLOW_BLOCK == overflow
+            ? timeout_ms : 0, 0);
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+
+    while (MPMC_RET_FAIL == mpmc_push(q, data)) {
+        if (!mpmc_full(q)) {
+            retries++;
+            rdl_backoff_wait(&bo);
+            continue;   // Slot not yet released by its consumer
+        }
+        if (PARALEXECLIST_OVERFLOW_DIVERT == overflow) {
+            plt->overflow_routine(data);
+            return 0;
+        }
+        if (PARALEXECLIST_OVERFLOW_DROP_OLDEST == overflow) {
+            if (MPMC_RET_SUCCESS == mpmc_pop(q, &oldest)) {
+                paralexeclist_overflowed(plt, oldest);
+            }
+            continue;
+        }
+        if (PARALEXECLIST_WAIT_PARK != (ret = paralexeclist_waiter_next(plt,
+                &w))) {
+            if (0 != ret) {
+                return PARALEXECLIST_RET_EMPTY == ret ? PARALEXECLIST_RET_FULL
+                        : ret;
+            }
+            continue;
+        }
+
+        seq = paralexeclist_park_prepare(plt->idle_ev);
+        paralexeclist_park(plt->idle_ev, seq, mpmc_full(q), &w,
+                w.timeout_ms > 0 ? &(w.remain) : 0);
+    }
+
+    if (plt->stats) {
+        paralexeclist_stats_add(plt, 0, retries, 1, 0);
+    }
+
+    if (plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(plt->enrolled_ev, 1);
+    }
+    paralexeclist_notify(plt);
+
+    return 0;
+}
+
+/*
+ * Remove data from the ring, waiting with waiter while it is empty.
+ */
+static int paralexeclist_ring_get(paralexeclist *plt, paralexeclist_waiter *w,
+        void **data) {
+    mpmc *q = &(plt->shared->ring);
+    unsigned long retries = 0;
+    rdl_backoff bo;
+    unsigned int seq;
+    int ret;
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    while (MPMC_RET_FAIL == mpmc_pop(q, data)) {
+        if (!mpmc_empty(q)) {
+            retries++;
+            rdl_backoff_wait(&bo);
+            continue;   // Slot not yet filled by its producer
+        }
+        if (PARALEXECLIST_WAIT_PARK != (ret = paralexeclist_waiter_next(plt,
+                w))) {
+            if (0 != ret) {
+                if (plt->stats) {
+                    paralexeclist_stats_add(plt, 0, retries, 0, 0);
+                }
+                return ret;
+            }
+            continue;
+        }
+
+        seq = paralexeclist_park_prepare(plt->enrolled_ev);
+        paralexeclist_park(plt->enrolled_ev, seq, mpmc_empty(q), w,
+                w->timeout_ms > 0 ? &(w->remain) : 0);
+    }
+
+    if (plt->stats) {
+        paralexeclist_stats_add(plt, 0, retries, 0, 1);
+    }
+
+    if (plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(plt->idle_ev, 1);
+    }
+
+    return 0;
+}
+
+/*
+ * Add a chain of count elements to a side of the list and wake as many
+ * threads waiting on it.
+ */
+static int paralexeclist_give(paralexeclist *plt, rdl *rdl,
+        paralexeclist_event *ev, rdl_element *first, rdl_element *last,
+        int count) {
+    rdl_stats st = {0, 0, 0, 0};
+    rdl_stats *pst = plt->stats || plt->flags & PARALEXECLIST_ATTR_TRACE
+            ? &st : 0;
+    unsigned long retries = 0;
+    rdl_element *e;
+    rdl_backoff bo;
+    rdl_result res;
+    int n = count, parity = 0, i;
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    if (plt->elastic && RDL_TYPE_IDLE == rdl->type) {
+        paralexeclist_elastic_filter(plt, &first, &last, &count, 0);
+    }
+    if (RDL_TYPE_ENROLLED == rdl->type
+            && plt->flags & PARALEXECLIST_ATTR_TRACE) {
+        for (i = 0, e = first; i < count; i++, e = rdl_next(e)) {
+            paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_ENROLL,
+                    (char *) e - (char *) plt->shared, 0);
+        }
+    }
+
+    if (plt->elastic) {
+        parity = paralexeclist_elastic_enter(plt->elastic);
+    }
+    while (count && RDL_RET_FAIL == (res = first == last
+            ? rdl_add(rdl, first, pst, &bo)
+            : rdl_add_n(rdl, first, last, pst, &bo))) {
+        retries++;
+        rdl_backoff_wait(&bo);
+    }
+    if (plt->elastic) {
+        paralexeclist_elastic_leave(plt->elastic, parity);
+        if (RDL_TYPE_IDLE == rdl->type) {
+            paralexeclist_elastic_reclaim(plt);
+        }
+    }
+    if (count && RDL_RET_ERROR == res) {
+        return -1;
+    }
+
+    paralexeclist_account(plt, &st, retries,
+            RDL_TYPE_ENROLLED == rdl->type ? n : 0,
+            RDL_TYPE_IDLE == rdl->type ? n : 0);
+
+    if (plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(ev, count);
+    }
+    if (RDL_TYPE_ENROLLED == rdl->type) {
+        paralexeclist_notify(plt);
+    }
+
+    return 0;
+}
+
+/*
+ * Give a chain of count elements back to idle, each run of elements of a
+ * node to the pool of that node.
+ */
+static int paralexeclist_give_idle(paralexeclist *plt, rdl_element *first,
+        rdl_element *last, int count) {
+    rdl_element *e, *n;
+    int node, run;
+
+    if (1 == count && plt->flags & PARALEXECLIST_ATTR_EXCHANGE
+            && 0 == paralexeclist_exchange_give(plt, first)) {
+        return 0;
+    }
+
+    if (1 == plt->nodes) {
+        return paralexeclist_give(plt, plt->idle[0], plt->idle_ev, first,
+                last, count);
+    }
+
+    while (count > 0) {
+        node = paralexeclist_node_of(plt, first);
+        for (run = 1, e = first; run < count; run++, e = n) {
+            n = rdl_next(e);
+            if (node != paralexeclist_node_of(plt, n)) {
+                break;
+            }
+        }
+        n = rdl_next(e);    // Read before the run is linked into idle
+        if (0 != paralexeclist_give(plt, plt->idle[node], plt->idle_ev,
+                first, e, run)) {
+            return -1;
+        }
+        first = n;
+        count -= run;
+    }
+
+    return 0;
+}
+
+/*
+ * Data the calling thread runs, for routines to set a result or forward
+ */
+typedef struct paralexeclist_running {
+    paralexeclist *plt;
+    rdl_element *e;
+    paralexeclist_done *done;   // Completion state, 0 without a ticket
+    int stage;
+    int forward;            // Set once forwarded to the next stage
+} paralexeclist_running;
+
+static __thread paralexeclist_running paralexeclist_current;
+
+/*
+ * Completion state of an element if it has a ticket, 0 otherwise.
+ */
+static inline paralexeclist_done *paralexeclist_ticket_of(paralexeclist *plt,
+        rdl_element *e) {
+    paralexeclist_done *d;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TICKETS)) {
+        return 0;
+    }
+    d = paralexeclist_done_of(plt, e);
+    return __atomic_load_n(&(d->state), __ATOMIC_RELAXED)
+            & PARALEXECLIST_TICKET_STATE ? d : 0;
+}
+
+/*
+ * Finish data of a ticket with state, waking its waiter if it sleeps.
+ * The element then belongs to the waiter.
+ */
+static void paralexeclist_complete(paralexeclist_done *d,
+        unsigned int state) {
+    unsigned int old = __atomic_load_n(&(d->state), __ATOMIC_RELAXED);
+
+    // Generation kept, waiting flag cleared
+    while (!__atomic_compare_exchange_n(&(d->state), &old,
+            paralexeclist_ticket_gen(old) | state, 0, __ATOMIC_RELEASE,
+            __ATOMIC_RELAXED)) {
+    }
+    if (old & PARALEXECLIST_TICKET_WAITING) {
+        paralexeclist_futex(&(d->state), FUTEX_WAKE, INT_MAX, 0);
+    }
+}
+
+/*
+ * Index of an element, in the pools of the shared part, then in the
+ * segments of an elastic list, slot by slot.
+ */
+static unsigned long paralexeclist_elmt_index(paralexeclist *plt,
+        rdl_element *e) {
+    paralexeclist_shared *sh = plt->shared;
+    paralexeclist_elastic *el = plt->elastic;
+    int per = (sh->list_size + sh->nodes - 1) / sh->nodes;
+    size_t off;
+    int i;
+
+    off = (char *) e - (char *) sh - sh->elmts;
+    if ((char *) e >= (char *) sh && off < sh->pool_len * sh->nodes) {
+        return off / sh->pool_len * per + off % sh->pool_len / sh->el_size;
+    }
+    for (i = 0; el && i < PARALEXECLIST_SEGMENTS_MAX; i++) {
+        off = (char *) e - (char *) el->seg[i].base;
+        if (el->seg[i].base && (char *) e >= (char *) el->seg[i].base
+                && off < (size_t) el->el_size * el->seg[i].count) {
+            return sh->list_size + (unsigned long) i * el->seg_size
+                    + off / el->el_size;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Element a ticket was given for, 0 if it names none of list.
+ */
+static rdl_element *paralexeclist_ticket_elmt(paralexeclist *plt,
+        paralexeclist_ticket ticket) {
+    paralexeclist_shared *sh = plt->shared;
+    paralexeclist_elastic *el = plt->elastic;
+    unsigned long i = (ticket & 0xffffffffUL) - 1;
+    int per = (sh->list_size + sh->nodes - 1) / sh->nodes;
+    paralexeclist_segment *seg;
+    void *base;
+
+    if (0 == (ticket & 0xffffffffUL)) {
+        return 0;
+    }
+    if (i < (unsigned long) sh->list_size) {
+        return (rdl_element *) ((char *) sh + sh->elmts
+                + sh->pool_len * (i / per) + (size_t) sh->el_size * (i % per));
+    }
+    i -= sh->list_size;
+    if (0 == el || i / el->seg_size >= PARALEXECLIST_SEGMENTS_MAX) {
+        return 0;
+    }
+    seg = &(el->seg[i / el->seg_size]);
+    base = __atomic_load_n(&(seg->base), __ATOMIC_ACQUIRE);
+    if (0 == base || i % el->seg_size >= (unsigned long) seg->count) {
+        return 0;
+    }
+    return (rdl_element *) ((char *) base
+            + (size_t) el->el_size * (i % el->seg_size));
+}
+
+/*
+ * Pipeline stage of the enrolled list an element was taken from.
+ */
+static inline int paralexeclist_stage_of(paralexeclist *plt,
+        rdl_element *e) {
+    int lane;
+
+    if (1 == plt->stages || e->owner >= plt->key_base) {
+        return 0;
+    }
+    lane = (e->owner - plt->nodes) / plt->shards;
+    return lane < plt->lanes ? 0 : lane - plt->lanes + 1;
+}
+
+/*
+ * Run the job of an element taken from enrolled, its own routine on its
+ * payload if it carries one, the routine of its stage on data otherwise,
+ * the list's consume routine for the first stage.
+ */
+static inline void paralexeclist_run(paralexeclist *plt, rdl_element *e) {
+    paralexeclist_running *cur = &paralexeclist_current;
+    paralexeclist_job *job;
+
+    cur->plt = plt;
+    cur->e = e;
+    cur->done = paralexeclist_ticket_of(plt, e);
+    cur->stage = paralexeclist_stage_of(plt, e);
+    cur->forward = 0;
+    paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_RUN,
+            (char *) e - (char *) plt->shared, cur->stage);
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS
+            && (job = paralexeclist_job_of(e))->routine) {
+        job->routine(job->payload);
+    } else if (cur->stage) {
+        plt->stage_handle[cur->stage](e->data);
+    } else {
+        plt->job_handle(e->data);
+    }
+    paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_DONE, 0, 0);
+    cur->plt = 0;
+}
+
+/*
+ * Pass an element just run on, to the next stage if its data were
+ * forwarded, or else to the waiter of its ticket. Returns 1 once passed
+ * on, 0 if the caller gives it back to idle, or -1 on error.
+ */
+static int paralexeclist_pass_on(paralexeclist *plt, rdl_element *e) {
+    paralexeclist_running *cur = &paralexeclist_current;
+
+    if (cur->forward) {
+        if (0 != paralexeclist_give(plt, plt->enrolled[(plt->lanes
+                + cur->stage) * plt->shards + paralexeclist_local_shard(plt)],
+                plt->enrolled_ev, e, e, 1)) {
+            return -1;
+        }
+        if (plt->stats) {
+            paralexeclist_stats_add(plt, 0, 0, 0, 1);   // Left its stage
+        }
+        return 1;
+    }
+    if (cur->done) {
+        paralexeclist_complete(cur->done, PARALEXECLIST_TICKET_DONE);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Take the oldest enrolled element of the lowest lane with data. If its
+ * data had a ticket, the element stays with the ticket and e is set to 0.
+ */
+static int paralexeclist_drop_oldest(paralexeclist *plt, rdl_element **e) {
+    paralexeclist_waiter w;
+    paralexeclist_job *job;
+    paralexeclist_done *d;
+    int lane, n, ret = PARALEXECLIST_RET_EMPTY;
+
+    for (lane = 0; lane < plt->lanes && PARALEXECLIST_RET_EMPTY == ret;
+            lane++) {
+        paralexeclist_waiter_init(&w, 0, 0);
+        ret = paralexeclist_take(plt, plt->enrolled + lane * plt->shards,
+                plt->shards, 1, paralexeclist_local_shard(plt),
+                plt->enrolled_ev, &w, 1, e, e, &n);
+    }
+    if (0 != ret) {
+        return ret;
+    }
+
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS
+            && (job = paralexeclist_job_of(*e))->routine) {
+        paralexeclist_overflowed(plt, job->payload);
+    } else {
+        paralexeclist_overflowed(plt, (*e)->data);
+    }
+    paralexeclist_key_done(plt, (*e)->owner);
+    rdl_element_reset(*e);
+
+    if ((d = paralexeclist_ticket_of(plt, *e))) {
+        paralexeclist_complete(d, PARALEXECLIST_TICKET_DROP);
+        *e = 0;
+    }
+
+    return 0;
+}
+
+/*
+ * Resolve the overflow policy of a call, taking that of list for
+ * PARALEXECLIST_OVERFLOW_DEFAULT. Returns -1 if it is not one list takes.
+ */
+static int paralexeclist_overflow_of(paralexeclist *plt, int *overflow,
+        int *timeout_ms) {
+    if (*overflow < PARALEXECLIST_OVERFLOW_DEFAULT
+            || *overflow > PARALEXECLIST_OVERFLOW_DIVERT
+            || (PARALEXECLIST_OVERFLOW_DIVERT == *overflow
+                    && 0 == plt->overflow_routine)) {
+        return -1;
+    }
+
+    if (PARALEXECLIST_OVERFLOW_DEFAULT == *overflow) {
+        *overflow = plt->overflow;
+        *timeout_ms = plt->overflow_ms;
+    }
+
+    return 0;
+}
 
 /*
- * Parallel execution list
+ * Take an idle element to produce into, applying overflow policy while
+ * idle is empty. Returns 0 with element in e, or with e set to 0 once the
+ * caller's data was diverted, otherwise the result to return.
  */
-typedef struct paralexeclist {
-    rdl* enrolled;
-    rdl* idle;
-    void (*job_handle)(void *);
-    rdl _enrolled;
-    rdl _idle;
-} paralexeclist;
+static int paralexeclist_reserve(paralexeclist *plt, int overflow,
+        int timeout_ms, void *data, rdl_element **e) {
+    paralexeclist_waiter w;
+    int n, ret;
+
+    while (1) {
+        paralexeclist_waiter_init(&w, PARALEXECLIST_OVERFLOW_BLOCK == overflow
+                ? timeout_ms : 0, 0);
+        if (PARALEXECLIST_RET_EMPTY != (ret = paralexeclist_take(plt,
+                plt->idle, plt->nodes, 1, paralexeclist_local_node(plt),
+                plt->idle_ev, &w, 1, e, e, &n))) {
+            return ret;
+        }
+
+        switch (overflow) {
+        case PARALEXECLIST_OVERFLOW_DIVERT:
+            plt->overflow_routine(data);
+            *e = 0;
+            return 0;
+        case PARALEXECLIST_OVERFLOW_DROP_OLDEST:
+            if (PARALEXECLIST_RET_EMPTY != (ret = paralexeclist_drop_oldest(
+                    plt, e)) && (0 != ret || *e)) {
+                return ret;
+            }
+            // Dropped data of a ticket, whose element comes back once the
+            // ticket is spent, or consumers hold every element: wait up to
+            // timeout_ms for one to come back to idle instead of spinning
+            overflow = PARALEXECLIST_OVERFLOW_BLOCK;
+            break;
+        default:
+            return PARALEXECLIST_RET_FULL;
+        }
+    }
+}
+
+extern int paralexeclist_attr_init(paralexeclist_attr *attr) {
+    if (0 == attr) {
+        return -1;
+    }
+
+    attr->flags = 0;
+    attr->consume_batch_routine = 0;
+    attr->shards = 0;
+    attr->max_size = 0;
+    attr->shrink_ms = 0;
+    attr->lanes = 0;
+    attr->prio_quota = 0;
+    attr->payload_size = 0;
+    attr->overflow = PARALEXECLIST_OVERFLOW_BLOCK;
+    attr->overflow_ms = -1;
+    attr->overflow_routine = 0;
+    attr->backoff = PARALEXECLIST_BACKOFF_NONE;
+    attr->backoff_limit = 0;
+    attr->keys = 0;
+    attr->stages = 0;
+    attr->stage_routines = 0;
+    return 0;
+}
 
 extern int paralexeclist_create(paralexeclist_t *plist, int list_size,
         void (*consume_routine)(void *), int *mem_len) {
-    int lt_size = sizeof(paralexeclist);
-    int dl_size = sizeof(rdl_element) * list_size;
+    size_t len;
+
+    if (0 == mem_len || 0 != paralexeclist_create_len(plist, list_size,
+            consume_routine, &len)) {
+        return -1;
+    }
+    // Length of the int * signature kept from before lists exceeded 2 GB
+    if (len > INT_MAX) {
+        paralexeclist_destroy(plist);
+        return -1;
+    }
+
+    *mem_len = (int) len;
+    return 0;
+}
+
+extern int paralexeclist_create_len(paralexeclist_t *plist, int list_size,
+        void (*consume_routine)(void *), size_t *mem_len) {
+    return paralexeclist_create_attr(plist, list_size, consume_routine, 0,
+            mem_len);
+}
+
+/*
+ * Number of NUMA nodes of the host, 1 if it cannot tell.
+ */
+static int paralexeclist_numa_nodes(void) {
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    int lo, hi = 0, c;
+
+    if (0 == f) {
+        return 1;
+    }
+    // Ranges of node ids as "0-1,3", the last is the highest
+    while (1 == fscanf(f, "%d", &lo)) {
+        hi = lo;
+        if (EOF == (c = fgetc(f)) || '\n' == c) {
+            break;
+        }
+    }
+    fclose(f);
+
+    return hi + 1 < PARALEXECLIST_NODES_MAX ? hi + 1
+            : PARALEXECLIST_NODES_MAX;
+}
+
+static inline size_t paralexeclist_page_align(size_t len) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    return (len + page - 1) & ~(page - 1);
+}
+
+/*
+ * Offset of elements from shared part of list of shards enrolled lists.
+ */
+static size_t paralexeclist_elmts_offset(int flags, int shards, int nodes) {
+    size_t off = sizeof(paralexeclist_shared)
+            + sizeof(paralexeclist_shard) * shards
+            + paralexeclist_stats_len(flags);
+    return nodes > 1 ? paralexeclist_page_align(off) : off;
+}
+
+/*
+ * Memory length of the element pool of a node.
+ */
+static size_t paralexeclist_pool_len(int list_size, int el_size,
+        int nodes) {
+    return nodes > 1 ? paralexeclist_page_align((size_t) ((list_size + nodes
+            - 1) / nodes) * el_size) : (size_t) el_size * list_size;
+}
+
+/*
+ * Bind the element pool of each node to the memory of that node, for pages
+ * faulted from now on or moved. Hosts or kernels without NUMA policy keep
+ * the pools wherever they are.
+ */
+static void paralexeclist_numa_bind(paralexeclist_shared *sh, int nodes) {
+    unsigned long mask;
+    int i;
+
+    for (i = 0; i < nodes; i++) {
+        mask = 1UL << i;
+        syscall(SYS_mbind, (char *) sh + sh->elmts + sh->pool_len * i,
+                (unsigned long) sh->pool_len, MPOL_PREFERRED, &mask,
+                sizeof(mask) * 8 + 1, MPOL_MF_MOVE);
+    }
+}
+
+/*
+ * Map zeroed memory of len bytes for a list private to the process. With
+ * PARALEXECLIST_ATTR_HUGEPAGE, reserved huge pages are tried first.
+ */
+static void *paralexeclist_map(size_t len, int flags) {
+    void *p = MAP_FAILED;
+
+    if (flags & PARALEXECLIST_ATTR_HUGEPAGE) {
+        p = mmap(0, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (MAP_FAILED == p) {
+        p = mmap(0, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                -1, 0);
+    }
+
+    return MAP_FAILED == p ? 0 : p;
+}
+
+/*
+ * Advise the kernel on the mapping of a list as flags tell: back it by
+ * transparent huge pages unless it already is on reserved ones, and fault
+ * its pages in now. Each process mapping the list does so for its own
+ * mapping, and failures only leave the mapping as it was.
+ */
+static void paralexeclist_advise(void *addr, size_t len, int flags) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    char *p;
+
+    if (flags & PARALEXECLIST_ATTR_HUGEPAGE) {
+        madvise(addr, len, MADV_HUGEPAGE);
+    }
+    if (flags & PARALEXECLIST_ATTR_PREFAULT
+            && 0 != madvise(addr, len, MADV_POPULATE_WRITE)) {
+        // Kernel before 5.14, fault pages one by one, writing nothing so
+        // that other processes attached to the list are not disturbed
+        for (p = (char *) addr; p < (char *) addr + len; p += page) {
+            __atomic_fetch_add(p, 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/*
+ * Memory length of shared part of list, size of its elements or ring
+ * slots, number of enrolled lists and of idle pools, returns 0 on error.
+ * The size of a ring is rounded up to a power of two, and the length to a
+ * huge page with PARALEXECLIST_ATTR_HUGEPAGE.
+ */
+static size_t paralexeclist_mem_len(int *list_size,
+        const paralexeclist_attr *attr, int *el_size, int *lists,
+        int *nodes) {
+    int flags = attr ? attr->flags : 0;
+    int shards = 1, lanes = 1, stages = 1;
+    size_t len;
+
+    if (attr && attr->max_size > *list_size
+            && flags & PARALEXECLIST_ATTR_RING) {
+        return 0;
+    }
+
+    if (attr && attr->shards) {
+        shards = PARALEXECLIST_SHARDS_PER_CPU == attr->shards
+                ? sysconf(_SC_NPROCESSORS_ONLN) : attr->shards;
+        if (shards > PARALEXECLIST_SHARDS_MAX) {
+            shards = PARALEXECLIST_SHARDS_MAX;
+        }
+        if (shards <= 0 || (flags & PARALEXECLIST_ATTR_RING && shards > 1)) {
+            return 0;
+        }
+    }
+
+    if (attr && attr->lanes > 1) {
+        lanes = attr->lanes;
+        if (lanes > PARALEXECLIST_LANES_MAX || attr->prio_quota < 0
+                || flags & PARALEXECLIST_ATTR_RING) {
+            return 0;
+        }
+    }
+
+    if (flags & PARALEXECLIST_ATTR_JOBS && (attr->payload_size < 0
+            || flags & PARALEXECLIST_ATTR_RING)) {
+        return 0;
+    }
+
+    if (flags & (PARALEXECLIST_ATTR_TICKETS | PARALEXECLIST_ATTR_EXCHANGE
+            | PARALEXECLIST_ATTR_TRACE | PARALEXECLIST_ATTR_TIMERS)
+            && flags & PARALEXECLIST_ATTR_RING) {
+        return 0;
+    }
+
+    if (flags & PARALEXECLIST_ATTR_EVENTFD
+            && flags & PARALEXECLIST_ATTR_TIMERS) {
+        return 0;
+    }
+
+    if (attr && attr->stages > 1) {
+        stages = attr->stages;
+        if (stages > PARALEXECLIST_STAGES_MAX
+                || flags & PARALEXECLIST_ATTR_RING) {
+            return 0;
+        }
+    }
+
+    if (attr && (attr->keys < 0 || attr->keys > PARALEXECLIST_KEYS_MAX
+            || (attr->keys && flags & PARALEXECLIST_ATTR_RING))) {
+        return 0;
+    }
+
+    if (flags & PARALEXECLIST_ATTR_RING) {
+        int capacity = 1;
+        while (capacity < *list_size) {
+            capacity <<= 1;
+        }
+        *list_size = capacity;
+        *el_size = sizeof(mpmc_slot);
+    } else {
+        *el_size = sizeof(rdl_element);
+    }
+    if (flags & PARALEXECLIST_ATTR_JOBS) {
+        *el_size += paralexeclist_job_len(attr->payload_size);
+    }
+    if (flags & PARALEXECLIST_ATTR_TICKETS) {
+        *el_size += sizeof(paralexeclist_done);
+    }
+    if (flags & PARALEXECLIST_ATTR_TIMERS) {
+        *el_size += sizeof(unsigned long);
+    }
+
+    if (flags & PARALEXECLIST_ATTR_CACHE_ALIGN) {
+        *el_size = (*el_size + PARALEXECLIST_CACHE_LINE - 1)
+                & ~(PARALEXECLIST_CACHE_LINE - 1);
+    }
+
+    *nodes = 1;
+    if (flags & PARALEXECLIST_ATTR_NUMA) {
+        if (flags & PARALEXECLIST_ATTR_RING || attr->max_size > *list_size) {
+            return 0;
+        }
+        *nodes = paralexeclist_numa_nodes();
+        if (*nodes > *list_size) {
+            *nodes = 1;
+        }
+    }
+
+    *lists = shards * (lanes + stages - 1);
+    len = paralexeclist_elmts_offset(flags, *lists + (attr ? attr->keys : 0)
+            + paralexeclist_wheel_slots(flags), *nodes)
+            + paralexeclist_pool_len(*list_size, *el_size, *nodes) * *nodes;
+    if (flags & PARALEXECLIST_ATTR_HUGEPAGE) {
+        len = (len + PARALEXECLIST_HUGE_PAGE - 1)
+                & ~(PARALEXECLIST_HUGE_PAGE - 1);
+    }
+    return len;
+}
+
+/*
+ * Lay out shared part of list on memory of mem_len bytes, before it is
+ * touched, so that element pools can be bound to their nodes.
+ */
+static void paralexeclist_layout_shared(paralexeclist_shared *sh,
+        int list_size, int el_size, int lists, int nodes,
+        const paralexeclist_attr *attr, size_t mem_len) {
+    sh->flags = attr ? attr->flags : 0;
+    sh->list_size = list_size;
+    sh->mem_len = mem_len;
+    sh->shards = lists;
+    sh->keys = attr ? attr->keys : 0;
+    sh->nodes = nodes;
+    sh->elmts = paralexeclist_elmts_offset(sh->flags, lists + sh->keys
+            + paralexeclist_wheel_slots(sh->flags), nodes);
+    sh->pool_len = paralexeclist_pool_len(list_size, el_size, nodes);
+    sh->el_size = el_size;
+    if (nodes > 1) {
+        paralexeclist_numa_bind(sh, nodes);
+    }
+}
+
+/*
+ * Initialize shared part of list on zeroed memory laid out, returning -1
+ * if the ring refuses its layout.
+ */
+static int paralexeclist_init_shared(paralexeclist_shared *sh, int el_size,
+        const paralexeclist_attr *attr) {
+    paralexeclist_shard *shard = paralexeclist_shard_at(sh);
+    paralexeclist_shard *key = paralexeclist_key_at(sh);
+    paralexeclist_shard *wheel = paralexeclist_wheel_at(sh);
+    int list_size = sh->list_size;
+    int per = (list_size + sh->nodes - 1) / sh->nodes;
+    int i;
+
+    sh->lanes = attr && attr->lanes > 1 ? attr->lanes : 1;
+    sh->stages = attr && attr->stages > 1 ? attr->stages : 1;
+    sh->prio_quota = attr && attr->prio_quota > 0 ? attr->prio_quota
+            : PARALEXECLIST_PRIO_QUOTA;
+    if (sh->flags & PARALEXECLIST_ATTR_JOBS) {
+        sh->payload_size = attr->payload_size;
+    }
+
+    // Idle pools take ids 0 to nodes - 1, enrolled shards the ones after,
+    // then key slots, then wheel slots
+    for (i = 0; i < sh->nodes; i++) {
+        rdl_init(&(sh->idle[i].list), RDL_TYPE_IDLE, i);
+    }
+    for (i = 0; i < sh->shards; i++) {
+        rdl_init(&(shard[i].list), RDL_TYPE_ENROLLED, sh->nodes + i);
+    }
+    for (i = 0; i < sh->keys; i++) {
+        rdl_init(&(key[i].list), RDL_TYPE_ENROLLED,
+                sh->nodes + sh->shards + i);
+    }
+    for (i = 0; i < paralexeclist_wheel_slots(sh->flags); i++) {
+        rdl_init(&(wheel[i].list), RDL_TYPE_ENROLLED,
+                sh->nodes + sh->shards + sh->keys + i);
+    }
+    sh->wheel.tick = paralexeclist_now_ms();
+    sh->wheel.next = ULONG_MAX;
+
+    void *elmts = (void *) sh + sh->elmts;
+    if (sh->flags & PARALEXECLIST_ATTR_RING) {
+        if (MPMC_RET_SUCCESS != mpmc_init(&(sh->ring), elmts, list_size,
+                el_size)) {
+            return -1;
+        }
+    } else {
+        rdl_element *e, *h;
+        rdl *idle;
+
+        for (i = 0; i < list_size; i++) {
+            idle = &(sh->idle[i / per].list);
+            h = rdl_head(idle);
+            e = (rdl_element *) (elmts + (size_t) sh->pool_len * (i / per)
+                    + (size_t) el_size * (i % per));
+            e->owner = idle->id;
+            rdl_add_elmt(rdl_prev(h), e, h);
+        }
+    }
+
+    __atomic_store_n(&(sh->magic), PARALEXECLIST_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/*
+ * Allocate a process-local handle of shared part of list.
+ */
+static paralexeclist *paralexeclist_open(paralexeclist_shared *sh,
+        void (*consume_routine)(void *), const paralexeclist_attr *attr) {
+    paralexeclist_shard *shard = paralexeclist_shard_at(sh);
+    int i;
+
+    if (attr && (attr->backoff < PARALEXECLIST_BACKOFF_NONE
+            || attr->backoff > PARALEXECLIST_BACKOFF_YIELD
+            || attr->backoff_limit < 0
+            || attr->overflow < PARALEXECLIST_OVERFLOW_BLOCK
+            || attr->overflow > PARALEXECLIST_OVERFLOW_DIVERT
+            || (PARALEXECLIST_OVERFLOW_DIVERT == attr->overflow
+                    && 0 == attr->overflow_routine))) {
+        return 0;
+    }
+
+    if (sh->stages > 1 && (0 == attr || 0 == attr->stage_routines)) {
+        return 0;
+    }
+    for (i = 1; i < sh->stages; i++) {
+        if (0 == attr->stage_routines[i - 1]) {
+            return 0;
+        }
+    }
+
+    paralexeclist *plt = 0;
+    if (0 == (plt = (paralexeclist *) calloc(1, sizeof(paralexeclist)
+            + sizeof(rdl *) * sh->shards))) {
+        return 0;
+    }
+
+    plt->shared = sh;
+    plt->enrolled = (rdl **) (plt + 1);
+    plt->shards = sh->shards / (sh->lanes + sh->stages - 1);
+    plt->lanes = sh->lanes;
+    plt->stages = sh->stages;
+    for (i = 1; i < sh->stages; i++) {
+        plt->stage_handle[i] = attr->stage_routines[i - 1];
+    }
+    for (i = 0; i < sh->shards; i++) {
+        plt->enrolled[i] = &(shard[i].list);
+    }
+    plt->keyed = paralexeclist_key_at(sh);
+    plt->keys = sh->keys;
+    plt->key_base = sh->nodes + sh->shards;
+    plt->wheel = paralexeclist_wheel_at(sh);
+    plt->nodes = sh->nodes;
+    for (i = 0; i < sh->nodes; i++) {
+        plt->idle[i] = &(sh->idle[i].list);
+    }
+    plt->enrolled_ev = &(sh->enrolled_ev);
+    plt->idle_ev = &(sh->idle_ev);
+    plt->job_handle = consume_routine;
+    plt->flags = sh->flags;
+    plt->payload_size = sh->payload_size;
+    plt->done_off = sizeof(rdl_element);
+    if (sh->flags & PARALEXECLIST_ATTR_JOBS) {
+        plt->done_off += paralexeclist_job_len(sh->payload_size);
+    }
+    plt->due_off = plt->done_off;
+    if (sh->flags & PARALEXECLIST_ATTR_TICKETS) {
+        plt->due_off += sizeof(paralexeclist_done);
+    }
+    if (sh->flags & PARALEXECLIST_ATTR_STATS) {
+        plt->stats = paralexeclist_stats_at(sh);
+    }
+    plt->overflow_ms = -1;
+    plt->efd = -1;
+    if (attr) {
+        plt->batch_handle = attr->consume_batch_routine;
+        plt->overflow = attr->overflow;
+        plt->overflow_ms = attr->overflow_ms;
+        plt->overflow_routine = attr->overflow_routine;
+        plt->backoff = (rdl_backoff_policy) attr->backoff;
+        plt->backoff_limit = attr->backoff_limit;
+    }
+
+    return plt;
+}
+
+extern int paralexeclist_create_attr(paralexeclist_t *plist, int list_size,
+        void (*consume_routine)(void *), const paralexeclist_attr *attr,
+        size_t *mem_len) {
+    if (list_size <= 0) {
+        return -1;
+    }
+
+    int el_size, lists, nodes;
+    size_t len = paralexeclist_mem_len(&list_size, attr, &el_size, &lists,
+            &nodes);
+    if (0 == len) {
+        return -1;
+    }
+
+    paralexeclist_shared *sh = 0;
+    if (0 == (sh = (paralexeclist_shared *) paralexeclist_map(len,
+            attr ? attr->flags : 0))) {
+        return -1;
+    }
+    paralexeclist_layout_shared(sh, list_size, el_size, lists, nodes, attr,
+            len);
+    paralexeclist_advise(sh, len, sh->flags);
+    if (0 != paralexeclist_init_shared(sh, el_size, attr)) {
+        munmap(sh, len);
+        return -1;
+    }
+
+    paralexeclist *plt = 0;
+    if (0 == (plt = paralexeclist_open(sh, consume_routine, attr))) {
+        munmap(sh, len);
+        return -1;
+    }
+    if (sh->flags & PARALEXECLIST_ATTR_EVENTFD && -1 == (plt->efd = eventfd(0,
+            EFD_NONBLOCK | EFD_CLOEXEC))) {
+        free(plt);
+        munmap(sh, len);
+        return -1;
+    }
+    if (attr && attr->max_size > list_size
+            && 0 != paralexeclist_elastic_init(plt, el_size, attr)) {
+        if (plt->efd >= 0) {
+            close(plt->efd);
+        }
+        free(plt);
+        munmap(sh, len);
+        return -1;
+    }
+
+    *mem_len = len;
+    *plist = (paralexeclist_t) plt;
+
+    return 0;
+}
+
+extern int paralexeclist_create_shm(paralexeclist_t *plist, const char *name,
+        int list_size, void (*consume_routine)(void *),
+        const paralexeclist_attr *attr, size_t *mem_len) {
+    if (0 == name || list_size <= 0
+            || (attr && (attr->max_size > list_size
+                    || attr->flags & PARALEXECLIST_ATTR_EVENTFD))) {
+        return -1;
+    }
+
+    int el_size, lists, nodes;
+    size_t len = paralexeclist_mem_len(&list_size, attr, &el_size, &lists,
+            &nodes);
+    if (0 == len) {
+        return -1;
+    }
+    int fd;
+
+    if (-1 == (fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600))) {
+        return -1;
+    }
+
+    paralexeclist_shared *sh = MAP_FAILED;
+    if (0 == ftruncate(fd, len)) {
+        sh = (paralexeclist_shared *) mmap(0, len, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == sh) {
+        shm_unlink(name);
+        return -1;
+    }
+    paralexeclist_layout_shared(sh, list_size, el_size, lists, nodes, attr,
+            len);
+    paralexeclist_advise(sh, len, sh->flags);
+    if (0 != paralexeclist_init_shared(sh, el_size, attr)) {
+        munmap(sh, len);
+        shm_unlink(name);
+        return -1;
+    }
+
+    paralexeclist *plt = 0;
+    if (0 == (plt = paralexeclist_open(sh, consume_routine, attr))
+            || 0 == (plt->shm_name = strdup(name))) {
+        free(plt);
+        munmap(sh, len);
+        shm_unlink(name);
+        return -1;
+    }
+
+    *mem_len = len;
+    *plist = (paralexeclist_t) plt;
+
+    return 0;
+}
+
+extern int paralexeclist_attach_shm(paralexeclist_t *plist, const char *name,
+        void (*consume_routine)(void *), const paralexeclist_attr *attr,
+        size_t *mem_len) {
+    if (0 == name) {
+        return -1;
+    }
+
+    struct stat st;
+    int fd;
+
+    if (-1 == (fd = shm_open(name, O_RDWR, 0))) {
+        return -1;
+    }
+
+    paralexeclist_shared *sh = MAP_FAILED;
+    if (0 == fstat(fd, &st) && st.st_size >= sizeof(paralexeclist_shared)) {
+        sh = (paralexeclist_shared *) mmap(0, st.st_size,
+                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == sh) {
+        return -1;
+    }
+
+    paralexeclist *plt = 0;
+    if (PARALEXECLIST_MAGIC != __atomic_load_n(&(sh->magic), __ATOMIC_ACQUIRE)
+            || st.st_size != sh->mem_len
+            || 0 == (plt = paralexeclist_open(sh, consume_routine, attr))) {
+        munmap(sh, st.st_size);
+        return -1;
+    }
+    paralexeclist_advise(sh, sh->mem_len, sh->flags);
+
+    *mem_len = sh->mem_len;
+    *plist = (paralexeclist_t) plt;
+
+    return 0;
+}
+
+extern int paralexeclist_produce(paralexeclist_t list, void *data) {
+    return paralexeclist_produce_prio(list, data, 0);
+}
+
+extern int paralexeclist_produce_prio(paralexeclist_t list, void *data,
+        int level) {
+    return paralexeclist_produce_ex(list, data, level,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
+
+extern int paralexeclist_produce_ex(paralexeclist_t list, void *data,
+        int level, int overflow, int timeout_ms) {
+    if (0 == list) {
+        return -1;
+    }
 
-    paralexeclist *plt = 0;
-    if (0 == (plt = (paralexeclist *) calloc(1, lt_size + dl_size))) {
+    paralexeclist *plt = (paralexeclist *) list;
+    if (level < 0 || level >= plt->lanes
+            || 0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
         return -1;
     }
 
-    plt->job_handle = consume_routine;
+    rdl_element *e;
+    int ret;
+
+    if (plt->flags & PARALEXECLIST_ATTR_RING) {
+        return paralexeclist_ring_put(plt, data, overflow, timeout_ms);
+    }
+
+    if (0 != (ret = paralexeclist_reserve(plt, overflow, timeout_ms, data,
+            &e)) || 0 == e) {
+        return ret;
+    }
 
-    plt->enrolled = &(plt->_enrolled);
-    plt->enrolled->head = &(plt->enrolled->nil);
-    plt->enrolled->type = RDL_TYPE_ENROLLED;
-    rdl_init_head(plt->enrolled->head);
+    e->data = data;
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS) {
+        paralexeclist_job_of(e)->routine = 0;
+    }
 
-    plt->idle = &(plt->_idle);
-    plt->idle->head = &(plt->idle->nil);
-    plt->idle->type = RDL_TYPE_IDLE;
-    rdl_init_head(plt->idle->head);
+    return paralexeclist_give(plt, plt->enrolled[level * plt->shards
+            + paralexeclist_local_shard(plt)], plt->enrolled_ev, e, e, 1);
+}
 
-    rdl_element *e = (rdl_element *) ((void *) plt + lt_size);
-    int i = 0;
+extern int paralexeclist_produce_job(paralexeclist_t list,
+        void (*routine)(void *), const void *payload, int len) {
+    return paralexeclist_produce_job_ex(list, routine, payload, len,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
 
-    rdl_element *h = plt->idle->head;
-    while (i < list_size) {
-        rdl_add_elmt(h, e, h);
-        i++;
-        e++;
+extern int paralexeclist_produce_job_ex(paralexeclist_t list,
+        void (*routine)(void *), const void *payload, int len, int overflow,
+        int timeout_ms) {
+    if (0 == list || 0 == routine || len < 0 || (len && 0 == payload)) {
+        return -1;
     }
 
-    *mem_len = lt_size + dl_size;
-    *plist = (paralexeclist_t) plt;
+    paralexeclist *plt = (paralexeclist *) list;
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_JOBS)
+            || len > plt->payload_size
+            || 0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
+        return -1;
+    }
 
-    return 0;
+    paralexeclist_job *job;
+    rdl_element *e;
+    int ret;
+
+    if (0 != (ret = paralexeclist_reserve(plt, overflow, timeout_ms,
+            (void *) payload, &e)) || 0 == e) {
+        return ret;
+    }
+
+    job = paralexeclist_job_of(e);
+    job->routine = routine;
+    memcpy(job->payload, payload, len);
+
+    return paralexeclist_give(plt,
+            plt->enrolled[paralexeclist_local_shard(plt)], plt->enrolled_ev,
+            e, e, 1);
 }
 
-extern int paralexeclist_produce(paralexeclist_t list, void *data) {
+extern int paralexeclist_produce_keyed(paralexeclist_t list,
+        unsigned long key, void *data) {
+    return paralexeclist_produce_keyed_ex(list, key, data,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
+
+extern int paralexeclist_produce_keyed_ex(paralexeclist_t list,
+        unsigned long key, void *data, int overflow, int timeout_ms) {
     if (0 == list) {
         return -1;
     }
 
     paralexeclist *plt = (paralexeclist *) list;
+    if (0 == plt->keys
+            || 0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
+        return -1;
+    }
+
     rdl_element *e;
-    rdl_result res;
+    int ret;
 
-    while (RDL_RET_FAIL == (res = rdl_remove(plt->idle, &e))) {
+    if (0 != (ret = paralexeclist_reserve(plt, overflow, timeout_ms, data,
+            &e)) || 0 == e) {
+        return ret;
     }
-    if (RDL_RET_ERROR == res) {
+
+    e->data = data;
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS) {
+        paralexeclist_job_of(e)->routine = 0;
+    }
+
+    // Counted before it can be seen, so that a consumer finding no keyed
+    // data can park; Fibonacci hashing spreads close keys over slots
+    __atomic_add_fetch(&(plt->shared->keyed), 1, __ATOMIC_SEQ_CST);
+    if (0 != (ret = paralexeclist_give(plt, &(plt->keyed[(unsigned int)
+            ((key * 0x9e3779b97f4a7c15UL) >> 32) % plt->keys].list),
+            plt->enrolled_ev, e, e, 1))) {
+        __atomic_sub_fetch(&(plt->shared->keyed), 1, __ATOMIC_RELAXED);
+    }
+
+    return ret;
+}
+
+extern int paralexeclist_produce_at(paralexeclist_t list, void *data,
+        const struct timespec *deadline) {
+    return paralexeclist_produce_at_ex(list, data, deadline,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
+
+extern int paralexeclist_produce_at_ex(paralexeclist_t list, void *data,
+        const struct timespec *deadline, int overflow, int timeout_ms) {
+    if (0 == list || 0 == deadline || deadline->tv_sec < 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TIMERS)
+            || 0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
         return -1;
     }
 
+    rdl_element *e;
+    int ret;
+
+    if (0 != (ret = paralexeclist_reserve(plt, overflow, timeout_ms, data,
+            &e)) || 0 == e) {
+        return ret;
+    }
+
     e->data = data;
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS) {
+        paralexeclist_job_of(e)->routine = 0;
+    }
+
+    // Turned first, so that data are not filed from a tick long passed,
+    // and rounded up, so that they are never enrolled early
+    paralexeclist_wheel_turn(plt, 1);
+    return paralexeclist_wheel_file(plt, e, deadline->tv_sec * 1000UL
+            + (deadline->tv_nsec + 999999L) / 1000000L);
+}
 
-    while (RDL_RET_FAIL == (res = rdl_add(plt->enrolled, e))) {
+extern int paralexeclist_produce_ticket(paralexeclist_t list, void *data,
+        paralexeclist_ticket *ticket) {
+    return paralexeclist_produce_ticket_ex(list, data, ticket,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
+
+extern int paralexeclist_produce_ticket_ex(paralexeclist_t list, void *data,
+        paralexeclist_ticket *ticket, int overflow, int timeout_ms) {
+    if (0 == list || 0 == ticket) {
+        return -1;
     }
-    if (RDL_RET_ERROR == res) {
+
+    paralexeclist *plt = (paralexeclist *) list;
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TICKETS)
+            || 0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
+        return -1;
+    }
+
+    paralexeclist_done *d;
+    unsigned int gen;
+    rdl_element *e;
+    int ret;
+
+    *ticket = PARALEXECLIST_TICKET_NONE;
+    if (0 != (ret = paralexeclist_reserve(plt, overflow, timeout_ms, data,
+            &e)) || 0 == e) {
+        return ret;
+    }
+
+    e->data = data;
+    if (plt->flags & PARALEXECLIST_ATTR_JOBS) {
+        paralexeclist_job_of(e)->routine = 0;
+    }
+    d = paralexeclist_done_of(plt, e);
+    d->result = 0;
+    gen = paralexeclist_ticket_gen(d->state) + PARALEXECLIST_TICKET_GEN;
+    __atomic_store_n(&(d->state), gen | PARALEXECLIST_TICKET_PENDING,
+            __ATOMIC_RELAXED);
+
+    // Index of the element rather than its address, so that a ticket holds
+    // in every process, after the generation of its data
+    *ticket = (unsigned long) gen << 32 | (paralexeclist_elmt_index(plt, e)
+            + 1);
+
+    return paralexeclist_give(plt,
+            plt->enrolled[paralexeclist_local_shard(plt)], plt->enrolled_ev,
+            e, e, 1);
+}
+
+extern int paralexeclist_set_result(long result) {
+    paralexeclist_running *cur = &paralexeclist_current;
+
+    if (0 == cur->plt || 0 == cur->done) {
         return -1;
     }
 
+    cur->done->result = result;
     return 0;
 }
 
-extern int paralexeclist_consume(paralexeclist_t list) {
-    if (0 == list) {
+extern int paralexeclist_forward(void *data) {
+    paralexeclist_running *cur = &paralexeclist_current;
+
+    if (0 == cur->plt || cur->stage + 1 >= cur->plt->stages) {
+        return -1;
+    }
+
+    cur->e->data = data;
+    if (cur->plt->flags & PARALEXECLIST_ATTR_JOBS) {
+        paralexeclist_job_of(cur->e)->routine = 0;
+    }
+    cur->forward = 1;
+    return 0;
+}
+
+/*
+ * Wait with waiter until data of a ticket of generation gen are done,
+ * returning -1 if the element has passed to another generation.
+ */
+static int paralexeclist_ticket_wait(paralexeclist_done *d,
+        unsigned int gen, paralexeclist_waiter *w) {
+    unsigned int state;
+
+    for (;;) {
+        state = __atomic_load_n(&(d->state), __ATOMIC_ACQUIRE);
+        if (gen != paralexeclist_ticket_gen(state)
+                || 0 == (state & PARALEXECLIST_TICKET_STATE)) {
+            return -1;
+        }
+        if (PARALEXECLIST_TICKET_PENDING != (state
+                & PARALEXECLIST_TICKET_STATE)) {
+            return 0;
+        }
+        if (0 == w->timeout_ms || (w->timeout_ms > 0
+                && 0 != paralexeclist_remain(&(w->deadline), &(w->remain)))) {
+            return PARALEXECLIST_RET_TIMEOUT;
+        }
+        if (0 == (state & PARALEXECLIST_TICKET_WAITING)
+                && !__atomic_compare_exchange_n(&(d->state), &state,
+                        state | PARALEXECLIST_TICKET_WAITING, 0,
+                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            continue;   // Done meanwhile
+        }
+        paralexeclist_futex(&(d->state), FUTEX_WAIT,
+                state | PARALEXECLIST_TICKET_WAITING,
+                w->timeout_ms > 0 ? &(w->remain) : 0);
+    }
+}
+
+/*
+ * Take the result of a ticket of generation gen done, and give its element
+ * back to idle. Only the caller freeing the state spends it; others, and
+ * callers of another generation, get -1.
+ */
+static int paralexeclist_ticket_spend(paralexeclist *plt, rdl_element *e,
+        unsigned int gen, long *result) {
+    paralexeclist_done *d = paralexeclist_done_of(plt, e);
+    unsigned int state = __atomic_load_n(&(d->state), __ATOMIC_ACQUIRE);
+    long value = d->result;
+    int ret;
+
+    if (gen != paralexeclist_ticket_gen(state)
+            || (PARALEXECLIST_TICKET_DONE != state - gen
+                && PARALEXECLIST_TICKET_DROP != state - gen)) {
+        return -1;
+    }
+    ret = PARALEXECLIST_TICKET_DROP == state - gen
+            ? PARALEXECLIST_RET_DROPPED : 0;
+
+    // Free, keeping the generation for the next ticket of the element
+    if (!__atomic_compare_exchange_n(&(d->state), &state, gen, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return -1;
+    }
+    if (result) {
+        *result = ret ? 0 : value;
+    }
+    rdl_element_reset(e);
+
+    return 0 == paralexeclist_give_idle(plt, e, e, 1) ? ret : -1;
+}
+
+extern int paralexeclist_wait(paralexeclist_t list,
+        paralexeclist_ticket ticket, long *result, int timeout_ms) {
+    return paralexeclist_wait_all(list, &ticket, 1, result, timeout_ms);
+}
+
+extern int paralexeclist_wait_all(paralexeclist_t list,
+        const paralexeclist_ticket *tickets, int n, long *results,
+        int timeout_ms) {
+    if (0 == list || 0 == tickets || n < 0) {
         return -1;
     }
 
     paralexeclist *plt = (paralexeclist *) list;
+    paralexeclist_waiter w;
     rdl_element *e;
-    rdl_result res;
+    int ret = 0, i, r;
 
-    while (RDL_RET_FAIL == (res = rdl_remove(plt->enrolled, &e))) {
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TICKETS)) {
+        return -1;
     }
-    if (RDL_RET_ERROR == res) {
+    for (i = 0; i < n; i++) {
+        if (PARALEXECLIST_TICKET_NONE != tickets[i]
+                && 0 == paralexeclist_ticket_elmt(plt, tickets[i])) {
+            return -1;
+        }
+    }
+
+    // Spend none of the tickets until all are done
+    paralexeclist_waiter_init(&w, timeout_ms, 0);
+    for (i = 0; i < n; i++) {
+        if (PARALEXECLIST_TICKET_NONE != tickets[i]
+                && 0 != (r = paralexeclist_ticket_wait(paralexeclist_done_of(
+                        plt, paralexeclist_ticket_elmt(plt, tickets[i])),
+                        (unsigned int) (tickets[i] >> 32), &w))) {
+            return r;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        if (PARALEXECLIST_TICKET_NONE == tickets[i]) {
+            if (results) {
+                results[i] = 0;
+            }
+            continue;
+        }
+        e = paralexeclist_ticket_elmt(plt, tickets[i]);
+        if (0 != (r = paralexeclist_ticket_spend(plt, e,
+                (unsigned int) (tickets[i] >> 32),
+                results ? &(results[i]) : 0)) && -1 != ret) {
+            ret = r;
+        }
+    }
+
+    return ret;
+}
+
+extern int paralexeclist_produce_n(paralexeclist_t list, void **data, int n) {
+    return paralexeclist_produce_n_ex(list, data, n,
+            PARALEXECLIST_OVERFLOW_DEFAULT, 0);
+}
+
+extern int paralexeclist_produce_n_ex(paralexeclist_t list, void **data,
+        int n, int overflow, int timeout_ms) {
+    if (0 == list || 0 == data || n <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    if (0 != paralexeclist_overflow_of(plt, &overflow, &timeout_ms)) {
+        return -1;
+    }
+
+    paralexeclist_waiter w;
+    rdl_element *first, *last, *e;
+    int i = 0, j, count, ret;
+
+    if (plt->flags & PARALEXECLIST_ATTR_RING) {
+        while (i < n) {
+            if (0 != (ret = paralexeclist_ring_put(plt, data[i], overflow,
+                    timeout_ms))) {
+                return ret < 0 ? ret : i;
+            }
+            i++;
+        }
+        return i;
+    }
+
+    while (i < n) {
+        // Runs are taken while idle has elements, waiting for them only
+        // under PARALEXECLIST_OVERFLOW_BLOCK; the other policies apply to
+        // one element at a time once it runs out
+        paralexeclist_waiter_init(&w, PARALEXECLIST_OVERFLOW_BLOCK == overflow
+                ? timeout_ms : 0, 0);
+        ret = paralexeclist_take(plt, plt->idle, plt->nodes, 1,
+                paralexeclist_local_node(plt), plt->idle_ev, &w, n - i,
+                &first, &last, &count);
+        if (PARALEXECLIST_RET_EMPTY == ret
+                && PARALEXECLIST_OVERFLOW_BLOCK != overflow) {
+            if (0 == (ret = paralexeclist_reserve(plt, overflow, timeout_ms,
+                    data[i], &first)) && 0 == first) {
+                i++;    // Diverted
+                continue;
+            }
+            last = first;
+            count = 1;
+        }
+        if (0 != ret) {
+            return ret < 0 ? ret : i;
+        }
+
+        e = first;
+        for (j = 0; j < count; j++) {
+            e->data = data[i++];
+            if (plt->flags & PARALEXECLIST_ATTR_JOBS) {
+                paralexeclist_job_of(e)->routine = 0;
+            }
+            e = rdl_next(e);
+        }
+
+        if (0 != paralexeclist_give(plt,
+                plt->enrolled[paralexeclist_local_shard(plt)],
+                plt->enrolled_ev, first, last, count)) {
+            return -1;
+        }
+    }
+
+    return i;
+}
+
+extern int paralexeclist_consume(paralexeclist_t list) {
+    return paralexeclist_consume_timed(list, -1);
+}
+
+extern int paralexeclist_consume_timed(paralexeclist_t list, int timeout_ms) {
+    if (0 == list) {
         return -1;
     }
 
-    plt->job_handle(e->data);
+    paralexeclist_waiter w;
+    paralexeclist_waiter_init(&w, timeout_ms, 0);
+
+    return paralexeclist_consume_wait((paralexeclist *) list, &w);
+}
+
+extern int paralexeclist_consume_wait(paralexeclist *plt,
+        paralexeclist_waiter *w) {
+    rdl_element *e;
+    void *data;
+    int ret, n;
+
+    if (plt->flags & PARALEXECLIST_ATTR_RING) {
+        if (0 != (ret = paralexeclist_ring_get(plt, w, &data))) {
+            return ret;
+        }
+        plt->job_handle(data);
+        return 0;
+    }
+
+    if (0 != (ret = paralexeclist_take(plt, plt->enrolled, plt->shards,
+            plt->lanes + plt->stages - 1, paralexeclist_local_shard(plt),
+            plt->enrolled_ev, w, 1, &e, &e, &n))) {
+        return ret;
+    }
+
+    paralexeclist_run(plt, e);
+    paralexeclist_key_done(plt, e->owner);
+    if (0 != (ret = paralexeclist_pass_on(plt, e))) {
+        return 1 == ret ? 0 : -1;
+    }
     rdl_element_reset(e);
 
-    while (RDL_RET_FAIL == (res = rdl_add(plt->idle, e))) {
+    return paralexeclist_give_idle(plt, e, e, 1);
+}
+
+extern int paralexeclist_try_consume(paralexeclist_t list) {
+    return paralexeclist_consume_timed(list, 0);
+}
+
+/*
+ * Consume up to max data, waiting up to timeout_ms for the first one only.
+ */
+static int paralexeclist_consume_batch(paralexeclist *plt, int max,
+        int timeout_ms) {
+    void *data[PARALEXECLIST_BATCH_MAX];
+    paralexeclist_waiter w;
+    rdl_element *first, *last, *e, *next, *kept;
+    int total = 0, ret, count, i, n, owner = -1, left = 0;
+
+    while (total < max) {
+        count = max - total < PARALEXECLIST_BATCH_MAX
+                ? max - total : PARALEXECLIST_BATCH_MAX;
+
+        if (plt->flags & PARALEXECLIST_ATTR_RING) {
+            for (i = 0; i < count; i++) {
+                paralexeclist_waiter_init(&w, total + i ? 0 : timeout_ms,
+                        0);
+                if (0 != paralexeclist_ring_get(plt, &w, &(data[i]))) {
+                    break;
+                }
+            }
+            if (0 == (n = count = i)) {
+                break;
+            }
+        } else {
+            paralexeclist_waiter_init(&w, total ? 0 : timeout_ms, 0);
+            ret = paralexeclist_take(plt, plt->enrolled, plt->shards,
+                    plt->lanes + plt->stages - 1,
+                    paralexeclist_local_shard(plt), plt->enrolled_ev, &w,
+                    count, &first, &last, &count);
+            if (PARALEXECLIST_RET_EMPTY == ret) {
+                break;
+            }
+            if (0 != ret) {
+                return -1;
+            }
+
+            // Jobs run in place, their payload lives in the element, and
+            // so do data with a ticket or in a pipeline, whose element then
+            // leaves the chain if passed on
+            owner = first->owner;
+            e = first;
+            kept = 0;
+            for (i = 0, n = 0, left = 0; i < count; i++, e = next) {
+                next = rdl_next(e);
+                if (plt->stages > 1 || paralexeclist_ticket_of(plt, e)
+                        || (plt->flags & PARALEXECLIST_ATTR_JOBS
+                                && paralexeclist_job_of(e)->routine)) {
+                    paralexeclist_run(plt, e);
+                    if (0 != (ret = paralexeclist_pass_on(plt, e))) {
+                        if (1 != ret) {
+                            return -1;
+                        }
+                        continue;
+                    }
+                } else {
+                    data[n++] = e->data;
+                }
+                rdl_element_reset(e);
+                if (kept) {
+                    rdl_set_next(kept, e);
+                    rdl_set_prev(e, kept);
+                } else {
+                    first = e;
+                }
+                kept = e;
+                left++;
+            }
+            last = kept;
+        }
+
+        if (n) {
+            paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_RUN, 0, n);
+        }
+        if (plt->batch_handle) {
+            if (n) {
+                plt->batch_handle(data, n);
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                plt->job_handle(data[i]);
+            }
+        }
+        if (n) {
+            paralexeclist_trace_stamp(plt, PARALEXECLIST_TRACE_DONE, 0, 0);
+        }
+
+        if (0 == (plt->flags & PARALEXECLIST_ATTR_RING)) {
+            paralexeclist_key_done(plt, owner);
+            if (left && 0 != paralexeclist_give_idle(plt, first, last,
+                    left)) {
+                return -1;
+            }
+        }
+        total += count;
     }
-    if (RDL_RET_ERROR == res) {
+
+    return total;
+}
+
+extern int paralexeclist_consume_n(paralexeclist_t list, int max) {
+    if (0 == list || max <= 0) {
+        return -1;
+    }
+
+    return paralexeclist_consume_batch((paralexeclist *) list, max, -1);
+}
+
+extern int paralexeclist_reserve_n(paralexeclist_t list, void **payloads,
+        int max) {
+    if (0 == list || 0 == payloads || max <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    paralexeclist_waiter w;
+    rdl_element *first, *last, *e;
+    int count, i;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_JOBS)) {
+        return -1;
+    }
+
+    paralexeclist_waiter_init(&w, -1, 0);
+    if (0 != paralexeclist_take(plt, plt->idle, plt->nodes, 1,
+            paralexeclist_local_node(plt), plt->idle_ev, &w,
+            max < PARALEXECLIST_BATCH_MAX ? max : PARALEXECLIST_BATCH_MAX,
+            &first, &last, &count)) {
+        return -1;
+    }
+
+    for (i = 0, e = first; i < count; i++, e = rdl_next(e)) {
+        payloads[i] = paralexeclist_job_of(e)->payload;
+    }
+
+    return count;
+}
+
+extern int paralexeclist_commit_n(paralexeclist_t list, void **payloads,
+        int n) {
+    if (0 == list || 0 == payloads || n <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    rdl_element *first = 0, *prev = 0, *e;
+    int i;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_JOBS)) {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++, prev = e) {
+        e = paralexeclist_payload_elmt(payloads[i]);
+        e->data = payloads[i];
+        paralexeclist_job_of(e)->routine = 0;
+        if (prev) {
+            rdl_set_next(prev, e);
+            rdl_set_prev(e, prev);
+        } else {
+            first = e;
+        }
+    }
+
+    return paralexeclist_give(plt,
+            plt->enrolled[paralexeclist_local_shard(plt)], plt->enrolled_ev,
+            first, prev, n);
+}
+
+extern int paralexeclist_claim_n(paralexeclist_t list, void **payloads,
+        int max, int timeout_ms) {
+    if (0 == list || 0 == payloads || max <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    paralexeclist_waiter w;
+    rdl_element *first, *last, *e;
+    int ret, count, i;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_JOBS) || plt->keys
+            || plt->stages > 1 || plt->flags & PARALEXECLIST_ATTR_TICKETS) {
+        return -1;
+    }
+
+    paralexeclist_waiter_init(&w, timeout_ms, 0);
+    ret = paralexeclist_take(plt, plt->enrolled, plt->shards, plt->lanes,
+            paralexeclist_local_shard(plt), plt->enrolled_ev, &w,
+            max < PARALEXECLIST_BATCH_MAX ? max : PARALEXECLIST_BATCH_MAX,
+            &first, &last, &count);
+    if (PARALEXECLIST_RET_EMPTY == ret || PARALEXECLIST_RET_TIMEOUT == ret) {
+        return 0;
+    }
+    if (0 != ret) {
+        return -1;
+    }
+
+    for (i = 0, e = first; i < count; i++, e = rdl_next(e)) {
+        payloads[i] = paralexeclist_job_of(e)->payload;
+    }
+
+    return count;
+}
+
+extern int paralexeclist_complete_n(paralexeclist_t list, void **payloads,
+        int n) {
+    if (0 == list || 0 == payloads || n <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    rdl_element *first = 0, *prev = 0, *e;
+    int i;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_JOBS)) {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++, prev = e) {
+        e = paralexeclist_payload_elmt(payloads[i]);
+        rdl_element_reset(e);
+        if (prev) {
+            rdl_set_next(prev, e);
+            rdl_set_prev(e, prev);
+        } else {
+            first = e;
+        }
+    }
+
+    return paralexeclist_give_idle(plt, first, prev, n);
+}
+
+extern int paralexeclist_eventfd(paralexeclist_t list) {
+    if (0 == list) {
+        return -1;
+    }
+
+    return ((paralexeclist *) list)->efd;
+}
+
+extern int paralexeclist_drain(paralexeclist_t list, int max) {
+    if (0 == list || max <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    eventfd_t value;
+    int total;
+
+    if (plt->efd >= 0) {
+        eventfd_read(plt->efd, &value);
+        __atomic_store_n(&(plt->shared->notified), 0, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
+    // Data may be left once max are consumed, so come back for them
+    if (max == (total = paralexeclist_consume_batch(plt, max, 0))) {
+        paralexeclist_notify(plt);
+    }
+
+    return total;
+}
+
+extern int paralexeclist_get_stats(paralexeclist_t list,
+        paralexeclist_stats *stats) {
+    if (0 == list || 0 == stats) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    paralexeclist_stats_slot *slot;
+    int i;
+
+    if (0 == plt->stats) {
         return -1;
     }
 
+    memset(stats, 0, sizeof(paralexeclist_stats));
+    for (i = 0; i < PARALEXECLIST_STATS_SLOTS; i++) {
+        slot = &(plt->stats[i]);
+#define paralexeclist_stats_sum(f, sf)  ({                                  \
+            stats->f += __atomic_load_n(&(slot->sf), __ATOMIC_RELAXED);     \
+        })
+        paralexeclist_stats_sum(produced, produced);
+        paralexeclist_stats_sum(consumed, consumed);
+        paralexeclist_stats_sum(retries, retries);
+        paralexeclist_stats_sum(trylock_fail_next, rdl.trylock_fail_next);
+        paralexeclist_stats_sum(trylock_fail_prev, rdl.trylock_fail_prev);
+        paralexeclist_stats_sum(trylock_fail_elmt, rdl.trylock_fail_elmt);
+        paralexeclist_stats_sum(walked, rdl.walked);
+        paralexeclist_stats_sum(exchanged, exchanged);
+#undef paralexeclist_stats_sum
+    }
+
+    stats->depth = stats->produced > stats->consumed
+            ? stats->produced - stats->consumed : 0;
+    stats->depth_max = __atomic_load_n(&(plt->shared->depth_max),
+            __ATOMIC_RELAXED);
+    if (stats->depth > stats->depth_max) {
+        stats->depth_max = stats->depth;
+    }
+
     return 0;
 }
 
@@ -119,7 +2760,28 @@ extern int paralexeclist_destroy(paralexeclist_t *plist) {
         return -1;
     }
 
-    free(*plist);
+    paralexeclist *plt = (paralexeclist *) *plist;
+    int ret = 0;
+
+    if (plt->workers && 0 != paralexeclist_drain_and_stop(plt)) {
+        ret = -1;
+    }
+
+    if (0 != munmap(plt->shared, plt->shared->mem_len)) {
+        ret = -1;
+    }
+    if (plt->shm_name && 0 != shm_unlink(plt->shm_name)) {
+        ret = -1;
+    }
+    free(plt->shm_name);
+    if (plt->efd >= 0 && 0 != close(plt->efd)) {
+        ret = -1;
+    }
+    if (plt->elastic) {
+        paralexeclist_elastic_free(plt);
+    }
+
+    free(plt);
     *plist = 0;
-    return 0;
+    return ret;
 }
@@ -3,10 +3,11 @@
  *
  *   Description: Parallel execution list can run in multi-thread
  *                and multi-process environment.
- *                While runs in  multi-process environment, you need map
- *                paralexeclist_t on shared memory so that every process
- *                can reach, and as well as data pointer registered to parallel
- *                execution list.
+ *                While runs in  multi-process environment, create the list
+ *                with paralexeclist_create_shm and attach other processes
+ *                with paralexeclist_attach_shm, at any address. Data pointer
+ *                registered to parallel execution list must as well be
+ *                reachable by every process.
  *
  *    Created on: Oct 16, 2012
  *        Author: Kurt Zhi
@@ -16,31 +17,621 @@
 
 #ifndef PARALEXECLIST_H_
 #define PARALEXECLIST_H_
+#include <sched.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /*
  * Parallel execution list type
  */
 typedef void * paralexeclist_t;
 
+/*
+ * Return value of parallel execution list operations
+ */
+typedef enum paralexeclist_result {
+    PARALEXECLIST_RET_SUCCESS   = 0,
+    PARALEXECLIST_RET_ERROR     = -1,
+    PARALEXECLIST_RET_EMPTY     = 1,    // Nothing to consume
+    PARALEXECLIST_RET_TIMEOUT   = 2,    // Timed out while waiting
+    PARALEXECLIST_RET_FULL      = 3,    // No idle element to produce into
+    PARALEXECLIST_RET_DROPPED   = 4     // Data of ticket dropped on overflow
+} paralexeclist_result;
+
+/*
+ * Ticket of data to wait for, see paralexeclist_produce_ticket. It holds the
+ * generation of its element, so a ticket spent no more names the element.
+ */
+typedef unsigned long paralexeclist_ticket;
+
+/*
+ * Ticket of data diverted on overflow, done at once
+ */
+#define PARALEXECLIST_TICKET_NONE       0UL
+
+/*
+ * Flags of parallel execution list attributes
+ */
+typedef enum paralexeclist_attr_flag {
+    PARALEXECLIST_ATTR_PARK     = 0x01, // Park waiters on futex, not spin
+    PARALEXECLIST_ATTR_CACHE_ALIGN
+                                = 0x02, // Pad elements to own cache line
+    PARALEXECLIST_ATTR_RING     = 0x04, // Bounded array queue engine
+    PARALEXECLIST_ATTR_STATS    = 0x08, // Count operations and contention
+    PARALEXECLIST_ATTR_JOBS     = 0x10, // Elements carry routine and payload
+    PARALEXECLIST_ATTR_NUMA     = 0x20, // Idle pool per NUMA node
+    PARALEXECLIST_ATTR_HUGEPAGE = 0x40, // Back memory by huge pages
+    PARALEXECLIST_ATTR_PREFAULT = 0x80, // Fault memory in on creation
+    PARALEXECLIST_ATTR_TICKETS  = 0x100, // Elements carry completion state
+    PARALEXECLIST_ATTR_EXCHANGE = 0x200, // Hand elements to waiting producers
+    PARALEXECLIST_ATTR_TRACE    = 0x400, // Stamp data in per-thread buffers
+    PARALEXECLIST_ATTR_TIMERS   = 0x800, // Timer wheel of scheduled data
+    PARALEXECLIST_ATTR_EVENTFD  = 0x1000 // Tell data are ready on an eventfd
+} paralexeclist_attr_flag;
+
+/*
+ * Policy of a producer finding no idle element
+ */
+typedef enum paralexeclist_overflow {
+    PARALEXECLIST_OVERFLOW_DEFAULT
+                                = -1,   // Policy of the list, per call only
+    PARALEXECLIST_OVERFLOW_BLOCK
+                                = 0,    // Wait up to a timeout
+    PARALEXECLIST_OVERFLOW_FAIL = 1,    // Return PARALEXECLIST_RET_FULL
+    PARALEXECLIST_OVERFLOW_DROP_OLDEST
+                                = 2,    // Hand oldest enrolled data to
+                                        // overflow routine, reuse element
+    PARALEXECLIST_OVERFLOW_DIVERT
+                                = 3     // Hand data to overflow routine
+} paralexeclist_overflow;
+
+/*
+ * Backoff of a thread losing a lock or an operation on contention, before
+ * trying again
+ */
+typedef enum paralexeclist_backoff {
+    PARALEXECLIST_BACKOFF_NONE  = 0,    // Try again at once
+    PARALEXECLIST_BACKOFF_PAUSE = 1,    // One spin-wait hint
+    PARALEXECLIST_BACKOFF_EXP   = 2,    // Spin-wait hints doubling up to
+                                        // backoff_limit, with jitter
+    PARALEXECLIST_BACKOFF_YIELD = 3     // Give up the CPU
+} paralexeclist_backoff;
+
+/*
+ * Number of enrolled shards giving one shard per online CPU
+ */
+#define PARALEXECLIST_SHARDS_PER_CPU    -1
+
+/*
+ * Parallel execution list attributes
+ */
+typedef struct paralexeclist_attr {
+    int                         flags;  // Or-ed paralexeclist_attr_flag
+    void                        (*consume_batch_routine)(void **, int);
+                                        // Routine of paralexeclist_consume_n
+    int                         shards; // Number of enrolled shards, 0 or 1
+                                        // for a single enrolled list
+    int                         max_size;
+                                        // Ceiling the list grows to when
+                                        // idle runs dry, 0 not to grow
+    int                         shrink_ms;
+                                        // Time surplus of idle elements
+                                        // lasts before it is released,
+                                        // 0 for default
+    int                         lanes;  // Number of priority levels, 0 or
+                                        // 1 for a single one
+    int                         prio_quota;
+                                        // Data taken from higher levels in
+                                        // a row before a lower one gets
+                                        // its turn, 0 for default
+    int                         payload_size;
+                                        // Inline payload bytes of each
+                                        // element with
+                                        // PARALEXECLIST_ATTR_JOBS
+    int                         overflow;
+                                        // paralexeclist_overflow policy of
+                                        // this process
+    int                         overflow_ms;
+                                        // Time PARALEXECLIST_OVERFLOW_BLOCK
+                                        // waits, -1 for ever
+    void                        (*overflow_routine)(void *);
+                                        // Routine taking data dropped or
+                                        // diverted, or payload of a job
+    int                         backoff;
+                                        // paralexeclist_backoff policy of
+                                        // this process
+    int                         backoff_limit;
+                                        // Most spin-wait hints of
+                                        // PARALEXECLIST_BACKOFF_EXP, 0 for
+                                        // default
+    int                         keys;   // Number of key slots of
+                                        // paralexeclist_produce_keyed, 0
+                                        // for none
+    int                         stages; // Number of pipeline stages, 0 or
+                                        // 1 for none
+    void                        (**stage_routines)(void *);
+                                        // Routines of stages 1 to
+                                        // stages - 1 in this process
+} paralexeclist_attr;
+
+/*
+ * Snapshot of parallel execution list counters
+ */
+typedef struct paralexeclist_stats {
+    unsigned long               produced;
+    unsigned long               consumed;
+    unsigned long               retries;    // Operations failed and retried
+    unsigned long               trylock_fail_next;
+    unsigned long               trylock_fail_prev;
+    unsigned long               trylock_fail_elmt;
+    unsigned long               walked;     // Elements stepped over while
+                                            // looking for one to remove
+    unsigned long               exchanged;  // Elements handed from consumers
+                                            // to producers, not via idle
+    unsigned long               depth;      // Data enrolled
+    unsigned long               depth_max;  // Sampled high-water of depth
+} paralexeclist_stats;
+
+/*
+ *  Description: Initialize parallel execution list attributes to defaults.
+ *    Parameter: attr [out]             - Attributes to initialize.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_attr_init(paralexeclist_attr *attr);
+
 /*
  *  Description: Create Parallel execution list.
  *    Parameter: plist [out]            - Parallel execution list.
  *               list_size [in]         - Size of parallel execution list.
  *               consume_routine [in]   - Routine to consume data.
  *               mem_len [out]          - Memory length of list in bytes.
- * Return value: On success returns 0; on error, it returns -1.
+ * Return value: On success returns 0; on error, or if mem_len would not
+ *               fit in an int, it returns -1 with no list created.
  */
 extern int paralexeclist_create(paralexeclist_t *plist, int list_size,
         void (*consume_routine)(void *), int *mem_len);
 
+/*
+ *  Description: Create Parallel execution list, as paralexeclist_create
+ *               with a memory length of any size.
+ *    Parameter: plist [out]            - Parallel execution list.
+ *               list_size [in]         - Size of parallel execution list.
+ *               consume_routine [in]   - Routine to consume data.
+ *               mem_len [out]          - Memory length of list in bytes.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_create_len(paralexeclist_t *plist, int list_size,
+        void (*consume_routine)(void *), size_t *mem_len);
+
+/*
+ *  Description: Create Parallel execution list with attributes.
+ *               With PARALEXECLIST_ATTR_PARK, consumers of an empty list and
+ *               producers of a full list sleep on a futex word inside the
+ *               list, so the list still works in shared memory.
+ *               With PARALEXECLIST_ATTR_CACHE_ALIGN, every element is padded
+ *               to a cache line of its own so that locks of adjacent
+ *               elements do not share one; mem_len includes the padding.
+ *               With PARALEXECLIST_ATTR_RING, data are kept in a bounded
+ *               array queue with per-slot sequence numbers instead of
+ *               rounded double-linked lists, behind the same operations;
+ *               list_size is rounded up to a power of two.
+ *               With shards of attributes above 1, data are enrolled to one
+ *               of several lists picked by the CPU of the producer, and
+ *               consumers take from the list of their own CPU first, then
+ *               steal from the others. Not supported by the ring engine.
+ *               With PARALEXECLIST_ATTR_STATS, operations and contention
+ *               are counted in per-thread slots inside the list, see
+ *               paralexeclist_get_stats.
+ *               With max_size of attributes above list_size, a producer
+ *               finding idle empty appends a segment of up to list_size new
+ *               elements instead of waiting, until max_size elements exist.
+ *               Once more than two segments worth of elements stay idle for
+ *               shrink_ms, the newest segment is retired: its elements are
+ *               taken out of circulation as they come back to idle, and its
+ *               memory is freed when no operation can still see it. Not
+ *               supported by the ring engine nor in shared memory.
+ *               With lanes of attributes above 1, data are enrolled at a
+ *               priority level from 0 (lowest) to lanes - 1, each level with
+ *               its own shards, sharing the idle elements. Consumers take
+ *               from the highest level with data; once they took prio_quota
+ *               data in a row from higher levels while a lower one was not
+ *               empty, the lowest level with data gets one. Not supported
+ *               by the ring engine.
+ *               With PARALEXECLIST_ATTR_JOBS, each element also carries a
+ *               routine and payload_size bytes of inline payload, filled by
+ *               paralexeclist_produce_job, so small jobs need no allocation
+ *               of their own. Not supported by the ring engine.
+ *               With PARALEXECLIST_ATTR_NUMA on a host of several NUMA
+ *               nodes, elements are split in one idle pool per node, each
+ *               bound to the memory of its node where the kernel allows.
+ *               Producers take elements from the pool of their node first,
+ *               and consumers give them back to the pool they came from,
+ *               so elements stay local to the producers using them. On a
+ *               single node it changes nothing. Not supported by the ring
+ *               engine nor with max_size.
+ *               With backoff of attributes, a thread losing a trylock or a
+ *               whole operation to another one waits as told before trying
+ *               again, instead of pulling the contended cache line at once.
+ *               With keys of attributes above 0, data added by
+ *               paralexeclist_produce_keyed go to one of keys slots picked
+ *               by hashing their key. A consumer claims a slot for as long
+ *               as it runs data taken from it, and other consumers pass it
+ *               by meanwhile, so data of a key run in order and never two
+ *               at a time. Keys sharing a slot are serialized together, so
+ *               keys should well exceed consumers. Consumers take from key
+ *               slots and from priority levels in turn. Not supported by
+ *               the ring engine.
+ *               With PARALEXECLIST_ATTR_TICKETS, each element also carries
+ *               a completion state and a result, so that
+ *               paralexeclist_produce_ticket hands out a ticket to wait on
+ *               without a lock or condition of its own. The element of a
+ *               ticket stays out of idle until the ticket is waited on. Not
+ *               supported by the ring engine.
+ *               With stages of attributes above 1, the list is a pipeline
+ *               of stages sharing its elements: stage 0 runs
+ *               consume_routine on data produced, stage s runs
+ *               stage_routines[s - 1], and a routine handing data on with
+ *               paralexeclist_forward moves their element straight to the
+ *               enrolled shards of the next stage, with no trip through
+ *               idle. Consumers take from later stages first, so that the
+ *               pipeline drains, and paralexeclist_consume_n runs data one
+ *               by one rather than by batch. Data with a ticket are done
+ *               once a stage does not forward them. Not supported by the
+ *               ring engine.
+ *               With PARALEXECLIST_ATTR_EXCHANGE, a producer losing idle
+ *               to another thread, or finding it empty while it may wait,
+ *               waits a moment on one of a few exchange slots in the list
+ *               header, and a consumer giving one element back to idle
+ *               hands it to a producer waiting there if any, so the pair
+ *               skip adding to idle and removing from it. An element may
+ *               so reach a producer of another node with
+ *               PARALEXECLIST_ATTR_NUMA. Not supported by the ring engine.
+ *               With PARALEXECLIST_ATTR_TRACE, each element enrolled, won
+ *               by a consumer and run is stamped with the time stamp
+ *               counter in a ring buffer of the calling thread, with no
+ *               lock nor system call, and so are operations retried on
+ *               contention; see paralexeclist_trace_dump. Not supported by
+ *               the ring engine.
+ *               With PARALEXECLIST_ATTR_TIMERS, each element also carries
+ *               a due time, and the list a hierarchical timer wheel of
+ *               millisecond ticks that paralexeclist_produce_at files data
+ *               into in constant time. Consumers turn the wheel as they
+ *               take data, moving data due to the enrolled shards by
+ *               batch, and bound their parking by the next tick with data,
+ *               so scheduled data need no thread of their own. Not
+ *               supported by the ring engine.
+ *               With PARALEXECLIST_ATTR_EVENTFD, the list opens an eventfd,
+ *               see paralexeclist_eventfd, that turns readable once data
+ *               are enrolled after the last paralexeclist_drain, with one
+ *               write however many data follow, so an event loop can poll
+ *               it with its other descriptors and drain the list when it
+ *               fires. Not supported in shared memory, nor together with
+ *               PARALEXECLIST_ATTR_TIMERS, whose data are only enrolled
+ *               while a consumer runs.
+ *               With PARALEXECLIST_ATTR_HUGEPAGE, the list is mapped on huge
+ *               pages, from the reserved pool (MAP_HUGETLB) if it has room,
+ *               else on transparent huge pages where the kernel allows, so
+ *               large lists take fewer TLB misses; mem_len is then rounded
+ *               up to a huge page.
+ *               With PARALEXECLIST_ATTR_PREFAULT, all pages of the list are
+ *               faulted in on creation, and on attaching in shared memory,
+ *               so first produces do not pay for it.
+ *    Parameter: plist [out]            - Parallel execution list.
+ *               list_size [in]         - Size of parallel execution list.
+ *               consume_routine [in]   - Routine to consume data.
+ *               attr [in]              - Attributes, 0 for defaults.
+ *               mem_len [out]          - Memory length of list in bytes.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_create_attr(paralexeclist_t *plist, int list_size,
+        void (*consume_routine)(void *), const paralexeclist_attr *attr,
+        size_t *mem_len);
+
+/*
+ *  Description: Create Parallel execution list on a named POSIX shared memory
+ *               object, which other processes can attach to.
+ *    Parameter: plist [out]            - Parallel execution list.
+ *               name [in]              - Name of shared memory object, must
+ *                                        not exist yet.
+ *               list_size [in]         - Size of parallel execution list.
+ *               consume_routine [in]   - Routine to consume data.
+ *               attr [in]              - Attributes, 0 for defaults.
+ *               mem_len [out]          - Memory length of list in bytes.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_create_shm(paralexeclist_t *plist, const char *name,
+        int list_size, void (*consume_routine)(void *),
+        const paralexeclist_attr *attr, size_t *mem_len);
+
+/*
+ *  Description: Attach to Parallel execution list created by another process
+ *               with paralexeclist_create_shm.
+ *    Parameter: plist [out]            - Parallel execution list.
+ *               name [in]              - Name of shared memory object.
+ *               consume_routine [in]   - Routine to consume data in this
+ *                                        process.
+ *               attr [in]              - Attributes, only routines are taken,
+ *                                        0 for defaults.
+ *               mem_len [out]          - Memory length of list in bytes.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_attach_shm(paralexeclist_t *plist, const char *name,
+        void (*consume_routine)(void *), const paralexeclist_attr *attr,
+        size_t *mem_len);
+
 /*
  *  Description: Add data to parallel execution list for consuming later.
+ *               When no element is idle, the overflow policy of attributes
+ *               applies: PARALEXECLIST_OVERFLOW_BLOCK waits up to
+ *               overflow_ms; PARALEXECLIST_OVERFLOW_FAIL returns at once;
+ *               PARALEXECLIST_OVERFLOW_DROP_OLDEST takes the oldest data
+ *               of the lowest priority level with any, hands it to
+ *               overflow_routine if set, and enrolls data in its element,
+ *               or waits as PARALEXECLIST_OVERFLOW_BLOCK while consumers
+ *               hold every element; PARALEXECLIST_OVERFLOW_DIVERT hands data to
+ *               overflow_routine and returns 0.
  *    Parameter: list [in]              - Parallel execution list.
  *               data [in]              - A void pointer to data.
  * Return value: On success returns 0; on error, it returns -1.
+ *               With no idle element, it returns PARALEXECLIST_RET_FULL,
+ *               or PARALEXECLIST_RET_TIMEOUT once overflow_ms passed.
  */
 extern int paralexeclist_produce(paralexeclist_t list, void *data);
 
+/*
+ *  Description: Add data to parallel execution list at a priority level.
+ *               paralexeclist_produce adds at level 0.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               level [in]             - Priority level, from 0 (lowest) to
+ *                                        lanes of attributes - 1.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_prio(paralexeclist_t list, void *data,
+        int level);
+
+/*
+ *  Description: Add data to parallel execution list at a priority level,
+ *               overriding the overflow policy for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               level [in]             - Priority level, from 0 (lowest) to
+ *                                        lanes of attributes - 1.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_ex(paralexeclist_t list, void *data,
+        int level, int overflow, int timeout_ms);
+
+/*
+ *  Description: Add a job to parallel execution list, copying its payload
+ *               into the element, so that the consumer calls routine with
+ *               a pointer to the copy, valid until routine returns. The
+ *               list must be created with PARALEXECLIST_ATTR_JOBS. On a
+ *               list in shared memory, routine must be at the same address
+ *               in the consuming process.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               routine [in]           - Routine to run the job.
+ *               payload [in]           - Payload of job, 0 if len is 0.
+ *               len [in]               - Payload length in bytes, up to
+ *                                        payload_size of attributes.
+ * Return value: As paralexeclist_produce; a diverted job hands the
+ *               payload given to overflow_routine.
+ */
+extern int paralexeclist_produce_job(paralexeclist_t list,
+        void (*routine)(void *), const void *payload, int len);
+
+/*
+ *  Description: Add a job to parallel execution list as
+ *               paralexeclist_produce_job, overriding the overflow policy
+ *               for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               routine [in]           - Routine to run the job.
+ *               payload [in]           - Payload of job, 0 if len is 0.
+ *               len [in]               - Payload length in bytes, up to
+ *                                        payload_size of attributes.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce_job.
+ */
+extern int paralexeclist_produce_job_ex(paralexeclist_t list,
+        void (*routine)(void *), const void *payload, int len, int overflow,
+        int timeout_ms);
+
+/*
+ *  Description: Add data of a key to parallel execution list. Data of one
+ *               key are consumed in the order they were added, one at a
+ *               time, while data of other keys are consumed in parallel.
+ *               The list must be created with keys of attributes above 0.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               key [in]               - Key of data, such as the id of
+ *                                        the state data touch.
+ *               data [in]              - A void pointer to data.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_keyed(paralexeclist_t list,
+        unsigned long key, void *data);
+
+/*
+ *  Description: Add data of a key to parallel execution list as
+ *               paralexeclist_produce_keyed, overriding the overflow policy
+ *               for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               key [in]               - Key of data.
+ *               data [in]              - A void pointer to data.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_keyed_ex(paralexeclist_t list,
+        unsigned long key, void *data, int overflow, int timeout_ms);
+
+/*
+ *  Description: Add data to parallel execution list, to be enrolled once
+ *               deadline passed, at the millisecond, or at once if it did.
+ *               The list must be created with PARALEXECLIST_ATTR_TIMERS.
+ *               Data scheduled hold an element until enrolled, and
+ *               paralexeclist_drain_and_stop does not wait for them.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               deadline [in]          - Time of CLOCK_MONOTONIC to
+ *                                        enroll data at.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_at(paralexeclist_t list, void *data,
+        const struct timespec *deadline);
+
+/*
+ *  Description: Add data to parallel execution list to be enrolled at
+ *               deadline as paralexeclist_produce_at, overriding the
+ *               overflow policy for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               deadline [in]          - Time of CLOCK_MONOTONIC to
+ *                                        enroll data at.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_at_ex(paralexeclist_t list, void *data,
+        const struct timespec *deadline, int overflow, int timeout_ms);
+
+/*
+ *  Description: Add data to parallel execution list and hand out a ticket
+ *               to wait for it to be consumed. The list must be created
+ *               with PARALEXECLIST_ATTR_TICKETS. Every ticket must be waited
+ *               on until done, as its element only goes back to idle then.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               ticket [out]           - Ticket of data, or
+ *                                        PARALEXECLIST_TICKET_NONE once
+ *                                        data were diverted.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_ticket(paralexeclist_t list, void *data,
+        paralexeclist_ticket *ticket);
+
+/*
+ *  Description: Add data to parallel execution list with a ticket as
+ *               paralexeclist_produce_ticket, overriding the overflow
+ *               policy for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - A void pointer to data.
+ *               ticket [out]           - Ticket of data, or
+ *                                        PARALEXECLIST_TICKET_NONE once
+ *                                        data were diverted.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce.
+ */
+extern int paralexeclist_produce_ticket_ex(paralexeclist_t list, void *data,
+        paralexeclist_ticket *ticket, int overflow, int timeout_ms);
+
+/*
+ *  Description: Set the result of data with a ticket, from the consume
+ *               routine running them.
+ *    Parameter: result [in]            - Result handed to the waiter.
+ * Return value: On success returns 0; it returns -1 when the calling thread
+ *               runs no data with a ticket.
+ */
+extern int paralexeclist_set_result(long result);
+
+/*
+ *  Description: Hand data on to the next stage of the list, from the
+ *               routine of a stage running them. Their element moves to
+ *               the next stage once the routine returns, instead of going
+ *               back to idle.
+ *    Parameter: data [in]              - A void pointer to data for the
+ *                                        next stage.
+ * Return value: On success returns 0; it returns -1 when the calling thread
+ *               runs no data of a stage followed by another.
+ */
+extern int paralexeclist_forward(void *data);
+
+/*
+ *  Description: Wait for data of a ticket to be consumed, and take its
+ *               result. Once it returns other than PARALEXECLIST_RET_TIMEOUT,
+ *               the ticket is spent.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               ticket [in]            - Ticket of
+ *                                        paralexeclist_produce_ticket.
+ *               result [out]           - Result set by the consumer, 0 if it
+ *                                        set none, or 0 to ignore it.
+ *               timeout_ms [in]        - Timeout, 0 never waits, negative
+ *                                        waits forever.
+ * Return value: On success returns 0; on error, it returns -1, as for a
+ *               ticket already spent or not of list, or a list without
+ *               PARALEXECLIST_ATTR_TICKETS. It returns
+ *               PARALEXECLIST_RET_TIMEOUT once timeout_ms passed, and
+ *               PARALEXECLIST_RET_DROPPED if data were dropped on overflow.
+ */
+extern int paralexeclist_wait(paralexeclist_t list,
+        paralexeclist_ticket ticket, long *result, int timeout_ms);
+
+/*
+ *  Description: Wait for data of a group of tickets to be consumed, and take
+ *               their results. On timeout none of the tickets is spent.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               tickets [in]           - Array of tickets.
+ *               n [in]                 - Number of tickets in array.
+ *               results [out]          - Array of n results, or 0.
+ *               timeout_ms [in]        - Timeout for the whole group, 0
+ *                                        never waits, negative waits forever.
+ * Return value: As paralexeclist_wait, PARALEXECLIST_RET_DROPPED if data of
+ *               any ticket were dropped. A ticket given twice is spent once,
+ *               and -1 returned.
+ */
+extern int paralexeclist_wait_all(paralexeclist_t list,
+        const paralexeclist_ticket *tickets, int n, long *results,
+        int timeout_ms);
+
+/*
+ *  Description: Add a batch of data to parallel execution list, moving runs
+ *               of elements from idle to enrolled under one lock section.
+ *               Once idle runs out, the overflow policy applies as on
+ *               paralexeclist_produce, to one data at a time, and the
+ *               batch stops at the first data it gives up on.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - Array of void pointers to data.
+ *               n [in]                 - Number of data in array.
+ * Return value: On success returns the number of data from the start of
+ *               array that were enrolled, or diverted by
+ *               PARALEXECLIST_OVERFLOW_DIVERT, n unless the policy gave up;
+ *               on error, it returns -1.
+ */
+extern int paralexeclist_produce_n(paralexeclist_t list, void **data, int n);
+
+/*
+ *  Description: Add a batch of data to parallel execution list as
+ *               paralexeclist_produce_n, overriding the overflow policy
+ *               for this call.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               data [in]              - Array of void pointers to data.
+ *               n [in]                 - Number of data in array.
+ *               overflow [in]          - paralexeclist_overflow policy, or
+ *                                        PARALEXECLIST_OVERFLOW_DEFAULT.
+ *               timeout_ms [in]        - Time PARALEXECLIST_OVERFLOW_BLOCK
+ *                                        waits, -1 for ever.
+ * Return value: As paralexeclist_produce_n.
+ */
+extern int paralexeclist_produce_n_ex(paralexeclist_t list, void **data,
+        int n, int overflow, int timeout_ms);
+
 /*
  *  Description: Consuming data on parallel execution list
  *    Parameter: list [in]              - Parallel execution list.
@@ -49,10 +640,186 @@ extern int paralexeclist_produce(paralexeclist_t list, void *data);
 extern int paralexeclist_consume(paralexeclist_t list);
 
 /*
- *  Description: Destroy parallel execution list
+ *  Description: Consuming data on parallel execution list, waiting at most
+ *               timeout_ms milliseconds for data to arrive.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               timeout_ms [in]        - Timeout, negative waits forever.
+ * Return value: On success returns 0; on timeout, it returns
+ *               PARALEXECLIST_RET_TIMEOUT; on error, it returns -1.
+ */
+extern int paralexeclist_consume_timed(paralexeclist_t list, int timeout_ms);
+
+/*
+ *  Description: Consuming data on parallel execution list without waiting.
+ *    Parameter: list [in]              - Parallel execution list.
+ * Return value: On success returns 0; if list is empty, it returns
+ *               PARALEXECLIST_RET_EMPTY; on error, it returns -1.
+ */
+extern int paralexeclist_try_consume(paralexeclist_t list);
+
+/*
+ *  Description: Consuming up to max data on parallel execution list, waiting
+ *               only for the first one. Data are handed in batches to
+ *               consume_batch_routine of attributes, or one by one to
+ *               consume routine if it is not set.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               max [in]               - Maximum number of data to consume.
+ * Return value: On success returns number of data consumed;
+ *               on error, it returns -1.
+ */
+extern int paralexeclist_consume_n(paralexeclist_t list, int max);
+
+/*
+ *  Description: Take up to max idle elements of parallel execution list
+ *               created with PARALEXECLIST_ATTR_JOBS, to build data right in
+ *               their payload before paralexeclist_commit_n enrolls them.
+ *               It waits for the first one whatever the overflow policy.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               payloads [out]         - Payloads of elements taken, of
+ *                                        payload_size bytes of attributes,
+ *                                        aligned as a pointer.
+ *               max [in]               - Maximum number of elements.
+ * Return value: On success returns number of elements taken; on error, it
+ *               returns -1.
+ */
+extern int paralexeclist_reserve_n(paralexeclist_t list, void **payloads,
+        int max);
+
+/*
+ *  Description: Enroll elements taken with paralexeclist_reserve_n, in
+ *               order. A consume routine gets the payload as data.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               payloads [in]          - Payloads of elements to enroll.
+ *               n [in]                 - Number of payloads.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_commit_n(paralexeclist_t list, void **payloads,
+        int n);
+
+/*
+ *  Description: Take up to max enrolled elements of parallel execution list
+ *               created with PARALEXECLIST_ATTR_JOBS, waiting at most
+ *               timeout_ms milliseconds for the first one, for the caller
+ *               to consume their payload in place, and give them back with
+ *               paralexeclist_complete_n. Not supported with keys, stages
+ *               nor PARALEXECLIST_ATTR_TICKETS, whose data need the list
+ *               once run.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               payloads [out]         - Payloads of elements taken.
+ *               max [in]               - Maximum number of elements.
+ *               timeout_ms [in]        - Timeout, 0 does not wait, negative
+ *                                        waits forever.
+ * Return value: On success returns number of elements taken, 0 if none
+ *               came in time; on error, it returns -1.
+ */
+extern int paralexeclist_claim_n(paralexeclist_t list, void **payloads,
+        int max, int timeout_ms);
+
+/*
+ *  Description: Give elements taken with paralexeclist_claim_n, or with
+ *               paralexeclist_reserve_n and not enrolled, back to idle.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               payloads [in]          - Payloads of elements to give back.
+ *               n [in]                 - Number of payloads.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_complete_n(paralexeclist_t list, void **payloads,
+        int n);
+
+/*
+ *  Description: Get the eventfd of parallel execution list created with
+ *               PARALEXECLIST_ATTR_EVENTFD, to poll for reading. It is non
+ *               blocking, and closed by paralexeclist_destroy.
+ *    Parameter: list [in]              - Parallel execution list.
+ * Return value: On success returns the file descriptor; if list has none,
+ *               or on error, it returns -1.
+ */
+extern int paralexeclist_eventfd(paralexeclist_t list);
+
+/*
+ *  Description: Consuming up to max data on parallel execution list without
+ *               waiting, as paralexeclist_consume_n does, after clearing
+ *               the readiness of its eventfd if any. The eventfd turns
+ *               readable again if data are enrolled meanwhile, or if max
+ *               data were consumed, as more may be left.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               max [in]               - Maximum number of data to consume.
+ * Return value: On success returns number of data consumed, 0 if list is
+ *               empty; on error, it returns -1.
+ */
+extern int paralexeclist_drain(paralexeclist_t list, int max);
+
+#ifdef CPU_SETSIZE
+/*
+ *  Description: Start n worker threads consuming parallel execution list
+ *               until paralexeclist_drain_and_stop. Worker i is pinned to
+ *               the (i % CPU_COUNT(cpus))-th CPU of cpus. Workers park
+ *               while the list is empty, so it must be created with
+ *               PARALEXECLIST_ATTR_PARK. Only declared when cpu_set_t is,
+ *               that is with _GNU_SOURCE defined.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               n [in]                 - Number of workers.
+ *               cpus [in]              - CPUs to pin workers on, or 0 not
+ *                                        to pin them.
+ * Return value: On success returns 0; on error, if workers are already
+ *               started, or if list lacks PARALEXECLIST_ATTR_PARK, it
+ *               returns -1 with no worker left running. Workers started
+ *               before an error stop after the job at hand, if any,
+ *               leaving the other jobs enrolled.
+ */
+extern int paralexeclist_start_workers(paralexeclist_t list, int n,
+        const cpu_set_t *cpus);
+#endif
+
+/*
+ *  Description: Stop worker threads of parallel execution list once every
+ *               job enrolled so far has been consumed, and wait for them to
+ *               exit. Producing must be over before calling it.
+ *    Parameter: list [in]              - Parallel execution list.
+ * Return value: On success returns 0; if no workers were started, or on
+ *               error, it returns -1.
+ */
+extern int paralexeclist_drain_and_stop(paralexeclist_t list);
+
+/*
+ *  Description: Take a snapshot of counters of parallel execution list
+ *               created with PARALEXECLIST_ATTR_STATS. Counters are summed
+ *               over every thread, of every process in shared memory, and
+ *               are not read atomically as a whole.
+ *    Parameter: list [in]              - Parallel execution list.
+ *               stats [out]            - Counters.
+ * Return value: On success returns 0; if list does not count, or on error,
+ *               it returns -1.
+ */
+extern int paralexeclist_get_stats(paralexeclist_t list,
+        paralexeclist_stats *stats);
+
+/*
+ *  Description: Write the events stamped by the threads of this process on
+ *               lists with PARALEXECLIST_ATTR_TRACE, in Chrome trace event
+ *               format (JSON), for chrome://tracing or Perfetto. The time
+ *               data waited enrolled shows as an async slice "queued" from
+ *               its enrolling to the consumer winning it, the time it ran
+ *               as a slice "run", or "batch" for a batch routine, on the
+ *               thread of the consumer, and retries as instant events.
+ *               Each thread keeps its latest 16384 events, and threads may
+ *               go on stamping while it runs.
+ *    Parameter: path [in]              - File to write.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_trace_dump(const char *path);
+
+/*
+ *  Description: Destroy parallel execution list, after draining and
+ *               stopping its workers if any. A list in shared memory is
+ *               unmapped, and its name removed by the creating process.
  *    Parameter: plist [in]              - Parallel execution list.
  * Return value: On success returns 0; on error, it returns -1.
  */
 extern int paralexeclist_destroy(paralexeclist_t *plist);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* PARALEXECLIST_H_ */
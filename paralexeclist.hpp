@@ -0,0 +1,270 @@
+/*****************************************************************************
+ * paralexeclist.hpp - Typed parallel execution list for C++17
+ *
+ *   Description: ParalExecList<T, Fn> keeps each T by value in the payload
+ *                of an element, moved in on produce and out to Fn on
+ *                consume, so data need no allocation of their own. Fn is a
+ *                template argument, a function taking T &&, so consume
+ *                calls it directly where it can be inlined, rather than
+ *                through the consume routine pointer. The list is created
+ *                with PARALEXECLIST_ATTR_JOBS and destroyed with the object,
+ *                after its workers if any are drained and stopped; T left
+ *                enrolled are then destroyed without running Fn.
+ *                Threads consuming the list with the C calls, workers
+ *                included, run Fn through a routine instead, where an
+ *                exception thrown by Fn calls std::terminate rather than
+ *                unwinding through C.
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#ifndef PARALEXECLIST_HPP_
+#define PARALEXECLIST_HPP_
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "paralexeclist.h"
+
+template <typename T, auto Fn>
+class ParalExecList {
+    static_assert(std::is_nothrow_destructible_v<T>,
+            "T is destroyed in place on consume");
+    static_assert(std::is_invocable_v<decltype(Fn), T &&>,
+            "Fn is called with T &&");
+
+public:
+    /*
+     * Most elements taken at once by the batch operations
+     */
+    static constexpr int batch = 64;
+
+    /*
+     *  Description: Create the list, throwing std::invalid_argument if attr
+     *               has keys, stages or PARALEXECLIST_ATTR_TICKETS, whose
+     *               data cannot be claimed, and std::runtime_error on other
+     *               errors.
+     *    Parameter: list_size      - Size of parallel execution list.
+     *               attr           - Attributes, 0 for defaults; flags
+     *                                are or-ed with
+     *                                PARALEXECLIST_ATTR_JOBS, and
+     *                                payload_size is set to fit T.
+     */
+    explicit ParalExecList(int list_size,
+            const paralexeclist_attr *attr = nullptr) {
+        paralexeclist_attr a;
+        size_t mem_len;
+
+        if (attr) {
+            if (attr->keys || attr->stages > 1
+                    || attr->flags & PARALEXECLIST_ATTR_TICKETS) {
+                throw std::invalid_argument("paralexeclist_attr");
+            }
+            a = *attr;
+        } else {
+            paralexeclist_attr_init(&a);
+        }
+        a.flags |= PARALEXECLIST_ATTR_JOBS;
+        a.payload_size = payload_size;
+        if (0 != paralexeclist_create_attr(&list_, list_size, &run, &a,
+                &mem_len)) {
+            throw std::runtime_error("paralexeclist_create_attr");
+        }
+    }
+
+    ParalExecList(const ParalExecList &) = delete;
+    ParalExecList &operator=(const ParalExecList &) = delete;
+
+    ParalExecList(ParalExecList &&other) noexcept
+            : list_(std::exchange(other.list_, nullptr)) {
+    }
+
+    ParalExecList &operator=(ParalExecList &&other) noexcept {
+        if (this != &other) {
+            close();
+            list_ = std::exchange(other.list_, nullptr);
+        }
+        return *this;
+    }
+
+    ~ParalExecList() {
+        close();
+    }
+
+    /*
+     * Handle for the C calls, such as paralexeclist_start_workers
+     */
+    paralexeclist_t native() const noexcept {
+        return list_;
+    }
+
+    /*
+     *  Description: Build a T in place in an idle element and enroll it.
+     * Return value: On success returns 0; on error, it returns -1.
+     */
+    template <typename... Args>
+    int emplace(Args &&... args) {
+        void *p;
+
+        if (1 != paralexeclist_reserve_n(list_, &p, 1)) {
+            return -1;
+        }
+        try {
+            ::new (at(p)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            paralexeclist_complete_n(list_, &p, 1);
+            throw;
+        }
+        return paralexeclist_commit_n(list_, &p, 1);
+    }
+
+    int produce(T &&v) {
+        return emplace(std::move(v));
+    }
+
+    int produce(const T &v) {
+        return emplace(v);
+    }
+
+    /*
+     *  Description: Move a range of T into the list, a batch of elements
+     *               at a time.
+     * Return value: On success returns 0; on error, it returns -1.
+     */
+    template <typename It>
+    int produce_n(It first, It last) {
+        void *p[batch];
+        int n, i;
+
+        while (first != last) {
+            if ((n = paralexeclist_reserve_n(list_, p, batch)) <= 0) {
+                return -1;
+            }
+            for (i = 0; i < n && first != last; i++, ++first) {
+                try {
+                    ::new (at(p[i])) T(std::move(*first));
+                } catch (...) {
+                    paralexeclist_complete_n(list_, p + i, n - i);
+                    if (i) {
+                        paralexeclist_commit_n(list_, p, i);
+                    }
+                    throw;
+                }
+            }
+            if (i < n) {
+                paralexeclist_complete_n(list_, p + i, n - i);
+            }
+            if (0 != paralexeclist_commit_n(list_, p, i)) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    /*
+     *  Description: Consume up to max T, waiting at most timeout_ms
+     *               milliseconds for the first. Elements are claimed a
+     *               batch at a time if Fn is noexcept, else one at a time,
+     *               so that if Fn throws only its T is lost, and the
+     *               exception is passed on.
+     * Return value: On success returns number of T consumed, 0 if none came
+     *               in time; on error, it returns -1.
+     */
+    int consume_n(int max, int timeout_ms = -1) {
+        void *p[batch];
+        int total = 0, n;
+
+        while (total < max) {
+            if ((n = paralexeclist_claim_n(list_, p, max - total < claim_max
+                    ? max - total : claim_max, total ? 0 : timeout_ms)) <= 0) {
+                return n < 0 && 0 == total ? -1 : total;
+            }
+            Claim claim{list_, p, n};
+            for (; claim.done < n; claim.done++) {
+                T *t = at(p[claim.done]);
+                Fn(std::move(*t));
+                t->~T();
+            }
+            total += n;
+        }
+        return total;
+    }
+
+    /*
+     *  Description: Consume one T, waiting at most timeout_ms milliseconds.
+     * Return value: On success returns 1, 0 if none came in time; on error,
+     *               it returns -1.
+     */
+    int consume(int timeout_ms = -1) {
+        return consume_n(1, timeout_ms);
+    }
+
+private:
+    // Elements claimed at once by consume_n
+    static constexpr int claim_max = std::is_nothrow_invocable_v<
+            decltype(Fn), T &&> ? batch : 1;
+
+    // Payload is aligned as a pointer, so room is left to align a T of
+    // stricter alignment
+    static constexpr int payload_size = static_cast<int>(sizeof(T)
+            + (alignof(T) > alignof(void *) ? alignof(T) - alignof(void *)
+                    : 0));
+
+    static T *at(void *p) noexcept {
+        if constexpr (alignof(T) > alignof(void *)) {
+            p = reinterpret_cast<void *>((reinterpret_cast<std::uintptr_t>(p)
+                    + alignof(T) - 1) & ~(std::uintptr_t(alignof(T)) - 1));
+        }
+        return std::launder(static_cast<T *>(p));
+    }
+
+    /*
+     * Routine of threads consuming through the C calls, which an exception
+     * must not unwind through
+     */
+    static void run(void *p) noexcept {
+        T *t = at(p);
+        Fn(std::move(*t));
+        t->~T();
+    }
+
+    /*
+     * Elements claimed, given back to idle once their T are consumed, or
+     * destroyed if Fn throws, which only a batch of one lets it do
+     */
+    struct Claim {
+        paralexeclist_t list;
+        void **p;
+        int n;
+        int done = 0;
+
+        ~Claim() {
+            for (; done < n; done++) {
+                at(p[done])->~T();
+            }
+            paralexeclist_complete_n(list, p, n);
+        }
+    };
+
+    void close() noexcept {
+        void *p[batch];
+        int n, i;
+
+        if (nullptr == list_) {
+            return;
+        }
+        paralexeclist_drain_and_stop(list_);
+        while ((n = paralexeclist_claim_n(list_, p, batch, 0)) > 0) {
+            for (i = 0; i < n; i++) {
+                at(p[i])->~T();
+            }
+            paralexeclist_complete_n(list_, p, n);
+        }
+        paralexeclist_destroy(&list_);
+    }
+
+    paralexeclist_t list_ = nullptr;
+};
+
+#endif /* PARALEXECLIST_HPP_ */
@@ -0,0 +1,448 @@
+/*****************************************************************************
+ * paralexeclist_bench.c - Throughput and latency benchmark of parallel
+ *                         execution list
+ *
+ * Every option taking a list is swept, one run per combination:
+ *  -p 1,2,4        producers
+ *  -c 1,2,4        consumers
+ *  -s 64,1024      list sizes
+ *  -w 0,200        payload cost, busy loop iterations in consume routine
+ *  -m thread,proc  threads of one process, or processes on shared memory
+ *  -e rdl,ring     engine
+ *  -b none,exp     backoff on contention: none, pause, exp or yield
+ * and the rest apply to every run:
+ *  -n 100000       data produced per producer
+ *  -x 0            enrolled shards, -1 for one per CPU
+ *  -k              park waiters on futex
+ *  -a              pad elements to cache lines
+ *  -S              count contention and print counters after each run
+ *  -X              hand elements from consumers to waiting producers, not
+ *                  via idle; ring runs leave it out
+ *  -T trace.json   stamp data in per-thread buffers and write them there
+ *                  as a Chrome trace at exit; ring runs leave it out
+ * Data carry their produce time, so every consume records enqueue to
+ * consume latency in a log-linear histogram of its consumer.
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "paralexeclist.h"
+
+#define BENCH_VALUES_MAX        16
+#define BENCH_SUB_BITS          4
+#define BENCH_SUB               (1 << BENCH_SUB_BITS)
+#define BENCH_BUCKETS           (64 * BENCH_SUB)
+#define BENCH_WAIT_MS           10
+
+/*
+ * Histogram of one consumer, in memory shared with forked consumers
+ */
+typedef struct bench_hist {
+    uint64_t count;
+    uint64_t last_ns;       // Time of last consume
+    uint64_t bucket[BENCH_BUCKETS];
+} __attribute__((aligned(64))) bench_hist;
+
+/*
+ * One run of the benchmark
+ */
+typedef struct bench_run {
+    int producers;
+    int consumers;
+    int list_size;
+    int work;
+    int process;
+    int ring;
+    int backoff;
+    long ops;               // Data per producer
+    paralexeclist_attr attr;
+    char shm_name[64];
+    paralexeclist_t list;
+    int go;                 // Released by the main thread or process
+    bench_hist *hist;       // One per consumer
+} bench_run;
+
+static bench_run *bench;
+static __thread bench_hist *bench_local;
+
+static inline uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Log-linear bucket of a value, BENCH_SUB buckets per power of two.
+ */
+static inline int bench_bucket(uint64_t v) {
+    if (v < BENCH_SUB) {
+        return (int) v;
+    }
+
+    int msb = 63 - __builtin_clzll(v);
+    return (msb - BENCH_SUB_BITS + 1) * BENCH_SUB
+            + (int) ((v >> (msb - BENCH_SUB_BITS)) & (BENCH_SUB - 1));
+}
+
+/*
+ * Lowest value of a bucket.
+ */
+static inline uint64_t bench_bucket_value(int b) {
+    if (b < BENCH_SUB) {
+        return b;
+    }
+
+    int msb = b / BENCH_SUB + BENCH_SUB_BITS - 1;
+    return ((uint64_t) (BENCH_SUB + b % BENCH_SUB)) << (msb - BENCH_SUB_BITS);
+}
+
+static void bench_consume(void *data) {
+    uint64_t now = bench_now();
+    volatile int i;
+
+    for (i = 0; i < bench->work; i++) {
+    }
+
+    bench_local->bucket[bench_bucket(now - (uint64_t) (uintptr_t) data)]++;
+    bench_local->last_ns = now;
+    __atomic_store_n(&(bench_local->count), bench_local->count + 1,
+            __ATOMIC_RELEASE);
+}
+
+static uint64_t bench_consumed(void) {
+    uint64_t sum = 0;
+    int i;
+
+    for (i = 0; i < bench->consumers; i++) {
+        sum += __atomic_load_n(&(bench->hist[i].count), __ATOMIC_ACQUIRE);
+    }
+    return sum;
+}
+
+/*
+ * Handle of the list in the calling thread or process.
+ */
+static paralexeclist_t bench_attach(void) {
+    paralexeclist_t list;
+    size_t mem_len;
+
+    if (!bench->process) {
+        return bench->list;
+    }
+    if (0 != paralexeclist_attach_shm(&list, bench->shm_name, bench_consume,
+            &(bench->attr), &mem_len)) {
+        fprintf(stderr, "attach %s failed\n", bench->shm_name);
+        exit(1);
+    }
+    return list;
+}
+
+static void bench_detach(paralexeclist_t list) {
+    if (bench->process) {
+        paralexeclist_destroy(&list);
+    }
+}
+
+static void *bench_producer(void *arg) {
+    paralexeclist_t list = bench_attach();
+    long i;
+
+    while (!__atomic_load_n(&(bench->go), __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+
+    for (i = 0; i < bench->ops; i++) {
+        if (0 != paralexeclist_produce(list,
+                (void *) (uintptr_t) bench_now())) {
+            fprintf(stderr, "produce failed\n");
+            exit(1);
+        }
+    }
+
+    bench_detach(list);
+    return 0;
+}
+
+static void *bench_consumer(void *arg) {
+    paralexeclist_t list = bench_attach();
+    uint64_t total = (uint64_t) bench->producers * bench->ops;
+    int ret;
+
+    bench_local = &(bench->hist[(intptr_t) arg]);
+    while (!__atomic_load_n(&(bench->go), __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+
+    while (1) {
+        ret = paralexeclist_consume_timed(list, BENCH_WAIT_MS);
+        if (PARALEXECLIST_RET_TIMEOUT == ret) {
+            if (bench_consumed() >= total) {
+                break;
+            }
+        } else if (0 != ret) {
+            fprintf(stderr, "consume failed\n");
+            exit(1);
+        }
+    }
+
+    bench_detach(list);
+    return 0;
+}
+
+/*
+ * Start a producer or consumer as a thread or a forked process.
+ */
+static int bench_spawn(void *(*routine)(void *), intptr_t index,
+        pthread_t *thread, pid_t *pid) {
+    if (!bench->process) {
+        return pthread_create(thread, 0, routine, (void *) index);
+    }
+
+    if (0 > (*pid = fork())) {
+        return -1;
+    }
+    if (0 == *pid) {
+        routine((void *) index);
+        _exit(0);
+    }
+    return 0;
+}
+
+static uint64_t bench_percentile(uint64_t *bucket, uint64_t count,
+        double p) {
+    uint64_t rank = (uint64_t) (count * p), seen = 0;
+    int b;
+
+    for (b = 0; b < BENCH_BUCKETS; b++) {
+        seen += bucket[b];
+        if (seen > rank) {
+            return bench_bucket_value(b);
+        }
+    }
+    return 0;
+}
+
+static int bench_one(void) {
+    int threads = bench->producers + bench->consumers;
+    pthread_t thread[threads];
+    pid_t pid[threads];
+    uint64_t start, end = 0, count = 0;
+    uint64_t bucket[BENCH_BUCKETS];
+    size_t mem_len;
+    int i, b, ret;
+
+    memset(bench->hist, 0, sizeof(bench_hist) * bench->consumers);
+    bench->go = 0;
+
+    if (bench->process) {
+        snprintf(bench->shm_name, sizeof(bench->shm_name),
+                "/paralexeclist_bench.%d", (int) getpid());
+        ret = paralexeclist_create_shm(&(bench->list), bench->shm_name,
+                bench->list_size, bench_consume, &(bench->attr), &mem_len);
+    } else {
+        ret = paralexeclist_create_attr(&(bench->list), bench->list_size,
+                bench_consume, &(bench->attr), &mem_len);
+    }
+    if (0 != ret) {
+        fprintf(stderr, "create failed\n");
+        return -1;
+    }
+
+    for (i = 0; i < threads; i++) {
+        if (0 != (i < bench->consumers
+                ? bench_spawn(bench_consumer, i, &(thread[i]), &(pid[i]))
+                : bench_spawn(bench_producer, 0, &(thread[i]), &(pid[i])))) {
+            fprintf(stderr, "spawn failed\n");
+            exit(1);
+        }
+    }
+
+    start = bench_now();
+    __atomic_store_n(&(bench->go), 1, __ATOMIC_RELEASE);
+
+    for (i = 0; i < threads; i++) {
+        if (bench->process) {
+            waitpid(pid[i], 0, 0);
+        } else {
+            pthread_join(thread[i], 0);
+        }
+    }
+    paralexeclist_stats stats;
+    int has_stats = 0 == paralexeclist_get_stats(bench->list, &stats);
+    paralexeclist_destroy(&(bench->list));
+
+    memset(bucket, 0, sizeof(bucket));
+    for (i = 0; i < bench->consumers; i++) {
+        for (b = 0; b < BENCH_BUCKETS; b++) {
+            bucket[b] += bench->hist[i].bucket[b];
+        }
+        count += bench->hist[i].count;
+        if (bench->hist[i].last_ns > end) {
+            end = bench->hist[i].last_ns;
+        }
+    }
+
+    static const char *const backoffs[] = {"none", "pause", "exp", "yield"};
+
+    printf("%-7s %-5s %-7s %4d %4d %6d %6d %10llu %12.0f %9llu %9llu"
+            " %9llu\n", bench->process ? "process" : "thread",
+            bench->ring ? "ring" : "rdl", backoffs[bench->backoff],
+            bench->producers, bench->consumers, bench->list_size, bench->work,
+            (unsigned long long) count,
+            end > start ? count * 1e9 / (end - start) : 0.0,
+            (unsigned long long) bench_percentile(bucket, count, 0.50),
+            (unsigned long long) bench_percentile(bucket, count, 0.99),
+            (unsigned long long) bench_percentile(bucket, count, 0.999));
+    if (has_stats) {
+        printf("  retries %lu trylock_fail next %lu prev %lu elmt %lu"
+                " walked %lu exchanged %lu depth_max %lu\n", stats.retries,
+                stats.trylock_fail_next, stats.trylock_fail_prev,
+                stats.trylock_fail_elmt, stats.walked, stats.exchanged,
+                stats.depth_max);
+    }
+    fflush(stdout);
+    return 0;
+}
+
+/*
+ * Parse comma separated list of integers, or of names with value of index.
+ */
+static int bench_parse(const char *arg, const char *const *names, int *values) {
+    char buf[256], *tok, *save = 0;
+    int n = 0, i;
+
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (tok = strtok_r(buf, ",", &save); tok && n < BENCH_VALUES_MAX;
+            tok = strtok_r(0, ",", &save)) {
+        if (0 == names) {
+            values[n++] = atoi(tok);
+            continue;
+        }
+        for (i = 0; names[i]; i++) {
+            if (0 == strcmp(tok, names[i])) {
+                values[n++] = i;
+                break;
+            }
+        }
+        if (0 == names[i]) {
+            fprintf(stderr, "unknown value %s\n", tok);
+            exit(2);
+        }
+    }
+    return n;
+}
+
+static void bench_usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-p producers] [-c consumers] [-s list_sizes]"
+            " [-w work] [-m thread,proc] [-e rdl,ring]"
+            " [-b none,pause,exp,yield] [-n ops] [-x shards] [-k] [-a] [-S]"
+            " [-X] [-T trace.json]\n",
+            prog);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    static const char *const modes[] = {"thread", "proc", 0};
+    static const char *const engines[] = {"rdl", "ring", 0};
+    static const char *const backoffs[] = {"none", "pause", "exp", "yield",
+            0};
+    int producers[BENCH_VALUES_MAX] = {1}, np = 1;
+    int consumers[BENCH_VALUES_MAX] = {1}, nc = 1;
+    int sizes[BENCH_VALUES_MAX] = {1024}, ns = 1;
+    int works[BENCH_VALUES_MAX] = {0}, nw = 1;
+    int procs[BENCH_VALUES_MAX] = {0}, nm = 1;
+    int rings[BENCH_VALUES_MAX] = {0}, ne = 1;
+    int policies[BENCH_VALUES_MAX] = {0}, nb = 1;
+    int ip, ic, is, iw, im, ie, ib, opt, flags = 0, max_consumers = 0;
+    long ops = 100000;
+    int shards = 0;
+    const char *trace = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "p:c:s:w:m:e:b:n:x:kaSXT:"))) {
+        switch (opt) {
+        case 'p': np = bench_parse(optarg, 0, producers); break;
+        case 'c': nc = bench_parse(optarg, 0, consumers); break;
+        case 's': ns = bench_parse(optarg, 0, sizes); break;
+        case 'w': nw = bench_parse(optarg, 0, works); break;
+        case 'm': nm = bench_parse(optarg, modes, procs); break;
+        case 'e': ne = bench_parse(optarg, engines, rings); break;
+        case 'b': nb = bench_parse(optarg, backoffs, policies); break;
+        case 'n': ops = atol(optarg); break;
+        case 'x': shards = atoi(optarg); break;
+        case 'k': flags |= PARALEXECLIST_ATTR_PARK; break;
+        case 'a': flags |= PARALEXECLIST_ATTR_CACHE_ALIGN; break;
+        case 'S': flags |= PARALEXECLIST_ATTR_STATS; break;
+        case 'X': flags |= PARALEXECLIST_ATTR_EXCHANGE; break;
+        case 'T': flags |= PARALEXECLIST_ATTR_TRACE; trace = optarg; break;
+        default: bench_usage(argv[0]);
+        }
+    }
+    for (ic = 0; ic < nc; ic++) {
+        if (consumers[ic] <= 0) {
+            bench_usage(argv[0]);
+        }
+        if (consumers[ic] > max_consumers) {
+            max_consumers = consumers[ic];
+        }
+    }
+
+    bench = (bench_run *) mmap(0, sizeof(bench_run)
+            + sizeof(bench_hist) * max_consumers, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == (void *) bench) {
+        perror("mmap");
+        return 1;
+    }
+    bench->hist = (bench_hist *) (bench + 1);
+    bench->ops = ops;
+
+    printf("%-7s %-5s %-7s %4s %4s %6s %6s %10s %12s %9s %9s %9s\n", "mode",
+            "engine", "backoff", "prod", "cons", "size", "work", "ops",
+            "ops/sec", "p50(ns)", "p99(ns)", "p999(ns)");
+
+    for (im = 0; im < nm; im++)
+    for (ie = 0; ie < ne; ie++)
+    for (ib = 0; ib < nb; ib++)
+    for (is = 0; is < ns; is++)
+    for (iw = 0; iw < nw; iw++)
+    for (ip = 0; ip < np; ip++)
+    for (ic = 0; ic < nc; ic++) {
+        bench->process = procs[im];
+        bench->ring = rings[ie];
+        bench->backoff = policies[ib];
+        bench->list_size = sizes[is];
+        bench->work = works[iw];
+        bench->producers = producers[ip];
+        bench->consumers = consumers[ic];
+
+        paralexeclist_attr_init(&(bench->attr));
+        bench->attr.flags = bench->ring ? (flags
+                & ~(PARALEXECLIST_ATTR_EXCHANGE | PARALEXECLIST_ATTR_TRACE))
+                | PARALEXECLIST_ATTR_RING : flags;
+        bench->attr.shards = bench->ring ? 0 : shards;
+        bench->attr.backoff = bench->backoff;
+
+        if (0 != bench_one()) {
+            return 1;
+        }
+    }
+
+    munmap(bench, sizeof(bench_run) + sizeof(bench_hist) * max_consumers);
+    // Only events of runs in threads, processes keep their own
+    if (trace && 0 != paralexeclist_trace_dump(trace)) {
+        perror(trace);
+        return 1;
+    }
+    return 0;
+}
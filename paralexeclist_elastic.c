@@ -0,0 +1,326 @@
+/*****************************************************************************
+ * paralexeclist_elastic.c - Elastic capacity of parallel execution list
+ *
+ * Retire: the retiring segment is left out of capacity, and its elements
+ * are taken out of circulation wherever they pass through idle, on either
+ * side, or by a periodic sweep of idle. The operation collecting the last
+ * one advances the epoch; the segment is freed once operations that
+ * entered the previous epoch have left, as only they can still walk links
+ * leading into it:
+ *  |     Operation         |     Collector             |     Reclaimer     |
+ *  |  e = epoch            |  collected == count       |                   |
+ *  |  active[e & 1]++      |  p = epoch++ & 1          |                   |
+ *  |  if (e != epoch)      |  freeing = seg            |                   |
+ *  |    retry              |  retiring = 0             |                   |
+ *  |  walk rdl lists       |                           |  if (!active[p])  |
+ *  |  active[e & 1]--      |                           |    free(seg)      |
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "paralexeclist_internal.h"
+
+static __thread unsigned int paralexeclist_elastic_tick;
+
+static long paralexeclist_elastic_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+}
+
+static inline int paralexeclist_elastic_trylock(paralexeclist_elastic *el) {
+    int unlocked = 0;
+    return __atomic_compare_exchange_n(&(el->lock), &unlocked, 1, 0,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ? 0 : -1;
+}
+
+static inline void paralexeclist_elastic_unlock(paralexeclist_elastic *el) {
+    __atomic_store_n(&(el->lock), 0, __ATOMIC_RELEASE);
+}
+
+extern int paralexeclist_elastic_init(paralexeclist *plt, int el_size,
+        const paralexeclist_attr *attr) {
+    paralexeclist_elastic *el = 0;
+    if (0 != posix_memalign((void **) &el, PARALEXECLIST_CACHE_LINE,
+            sizeof(paralexeclist_elastic))) {
+        return -1;
+    }
+    memset(el, 0, sizeof(paralexeclist_elastic));
+
+    el->max_size = attr->max_size;
+    el->seg_size = plt->shared->list_size;
+    el->el_size = el_size;
+    el->shrink_ms = attr->shrink_ms > 0 ? attr->shrink_ms
+            : PARALEXECLIST_SHRINK_MS;
+    el->capacity = plt->shared->list_size;
+
+    plt->elastic = el;
+    return 0;
+}
+
+extern void paralexeclist_elastic_free(paralexeclist *plt) {
+    paralexeclist_elastic *el = plt->elastic;
+    int i;
+
+    for (i = 0; i < PARALEXECLIST_SEGMENTS_MAX; i++) {
+        free(el->seg[i].base);
+    }
+    free(el);
+    plt->elastic = 0;
+}
+
+/*
+ * Add a chain of count elements to idle and wake as many producers.
+ */
+static int paralexeclist_elastic_give(paralexeclist *plt,
+        rdl_element *first, rdl_element *last, int count) {
+    paralexeclist_elastic *el = plt->elastic;
+    rdl_stats st = {0, 0, 0, 0};
+    rdl_stats *pst = plt->stats || plt->flags & PARALEXECLIST_ATTR_TRACE
+            ? &st : 0;
+    rdl_backoff bo;
+    rdl_result res;
+    int parity;
+
+    // rdl_add_n only returns once the chain is added, or on error
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    parity = paralexeclist_elastic_enter(el);
+    res = rdl_add_n(plt->idle[0], first, last, pst, &bo);
+    paralexeclist_elastic_leave(el, parity);
+    if (RDL_RET_ERROR == res) {
+        return -1;
+    }
+    paralexeclist_account(plt, &st, 0, 0, 0);
+
+    if (plt->flags & PARALEXECLIST_ATTR_PARK) {
+        paralexeclist_signal(plt->idle_ev, count);
+    }
+
+    return 0;
+}
+
+extern int paralexeclist_elastic_grow(paralexeclist *plt) {
+    paralexeclist_elastic *el = plt->elastic;
+    paralexeclist_segment *seg = 0;
+    rdl_element *e, *prev = 0;
+    int count, i;
+
+    if (__atomic_load_n(&(el->capacity), __ATOMIC_RELAXED) >= el->max_size) {
+        return -1;
+    }
+    if (0 != paralexeclist_elastic_trylock(el)) {
+        return 0;   // Being grown, or shrunk, by another thread
+    }
+
+    count = el->max_size - el->capacity;
+    if (count > el->seg_size) {
+        count = el->seg_size;
+    }
+    for (i = 0; i < PARALEXECLIST_SEGMENTS_MAX && 0 == seg; i++) {
+        if (0 == el->seg[i].base) {
+            seg = &(el->seg[i]);
+        }
+    }
+    if (count <= 0 || 0 == seg || 0 != posix_memalign(&(seg->base),
+            PARALEXECLIST_CACHE_LINE, (size_t) el->el_size * count)) {
+        if (seg) {
+            seg->base = 0;
+        }
+        paralexeclist_elastic_unlock(el);
+        return -1;
+    }
+    memset(seg->base, 0, (size_t) el->el_size * count);
+    seg->count = count;
+    seg->collected = 0;
+
+    // New elements are locked, as if just consumed
+    e = (rdl_element *) seg->base;
+    for (i = 0; i < count; i++) {
+        e->owner = plt->idle[0]->id;
+        e->lock = RDL_LOCK_ELMT;
+        if (prev) {
+            rdl_set_next(prev, e);
+            rdl_set_prev(e, prev);
+        }
+        prev = e;
+        e = (rdl_element *) ((void *) e + el->el_size);
+    }
+
+    __atomic_add_fetch(&(el->segments), 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&(el->capacity), count, __ATOMIC_RELAXED);
+    paralexeclist_elastic_unlock(el);
+
+    return paralexeclist_elastic_give(plt, (rdl_element *) seg->base, prev,
+            count);
+}
+
+/*
+ * Collected the last element of the retiring segment.
+ */
+static void paralexeclist_elastic_retired(paralexeclist_elastic *el,
+        paralexeclist_segment *seg) {
+    el->freeing_parity = __atomic_fetch_add(&(el->epoch), 1,
+            __ATOMIC_SEQ_CST) & 1;
+    __atomic_store_n(&(el->freeing), seg, __ATOMIC_RELEASE);
+    __atomic_store_n(&(el->retiring), 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Take elements of segment out of a chain, returns elements left.
+ */
+static int paralexeclist_elastic_collect(paralexeclist_elastic *el,
+        paralexeclist_segment *seg, rdl_element **first, rdl_element **last,
+        int count) {
+    char *lo = (char *) seg->base;
+    char *hi = lo + (size_t) el->el_size * seg->count;
+    rdl_element *e = *first, *n, *kept = 0;
+    int collected = 0, i;
+
+    for (i = 0; i < count; i++, e = n) {
+        n = rdl_next(e);
+        if ((char *) e >= lo && (char *) e < hi) {
+            collected++;
+            continue;
+        }
+        if (kept) {
+            rdl_set_next(kept, e);
+            rdl_set_prev(e, kept);
+        } else {
+            *first = e;
+        }
+        kept = e;
+    }
+    *last = kept;
+
+    if (collected && seg->count == __atomic_add_fetch(&(seg->collected),
+            collected, __ATOMIC_ACQ_REL)) {
+        paralexeclist_elastic_retired(el, seg);
+    }
+
+    return count - collected;
+}
+
+extern void paralexeclist_elastic_filter(paralexeclist *plt,
+        rdl_element **first, rdl_element **last, int *count, int taken) {
+    paralexeclist_elastic *el = plt->elastic;
+    paralexeclist_segment *seg = __atomic_load_n(&(el->retiring),
+            __ATOMIC_ACQUIRE);
+    int n = *count;
+
+    if (seg) {
+        *count = paralexeclist_elastic_collect(el, seg, first, last, n);
+    }
+
+    __atomic_add_fetch(&(el->in_use), taken ? *count : -n, __ATOMIC_RELAXED);
+}
+
+/*
+ * Pass idle elements through, collecting those of the retiring segment
+ * which were given back to idle without being filtered.
+ */
+static void paralexeclist_elastic_sweep(paralexeclist *plt,
+        paralexeclist_segment *seg) {
+    paralexeclist_elastic *el = plt->elastic;
+    rdl_stats st = {0, 0, 0, 0};
+    rdl_stats *pst = plt->stats || plt->flags & PARALEXECLIST_ATTR_TRACE
+            ? &st : 0;
+    rdl_element *first, *last;
+    rdl_backoff bo;
+    rdl_result res;
+    int rounds, count, parity;
+
+    rounds = (__atomic_load_n(&(el->capacity), __ATOMIC_RELAXED)
+            - __atomic_load_n(&(el->in_use), __ATOMIC_RELAXED) + seg->count)
+            / PARALEXECLIST_BATCH_MAX + 1;
+
+    rdl_backoff_init(&bo, plt->backoff, plt->backoff_limit);
+    while (rounds-- > 0 && seg == __atomic_load_n(&(el->retiring),
+            __ATOMIC_ACQUIRE)) {
+        parity = paralexeclist_elastic_enter(el);
+        res = rdl_remove_n(plt->idle[0], PARALEXECLIST_BATCH_MAX, &first, &last,
+                &count, pst, &bo);
+        paralexeclist_elastic_leave(el, parity);
+        if (RDL_RET_SUCCESS != res) {
+            break;
+        }
+
+        if (0 < (count = paralexeclist_elastic_collect(el, seg, &first, &last,
+                count)) && 0 != paralexeclist_elastic_give(plt, first, last,
+                count)) {
+            break;
+        }
+    }
+    paralexeclist_account(plt, &st, 0, 0, 0);
+}
+
+extern void paralexeclist_elastic_reclaim(paralexeclist *plt) {
+    paralexeclist_elastic *el = plt->elastic;
+    paralexeclist_segment *seg;
+    long now, since;
+    int idle, i;
+
+    seg = __atomic_load_n(&(el->freeing), __ATOMIC_ACQUIRE);
+    if (seg && 0 == __atomic_load_n(&(el->active[el->freeing_parity]),
+            __ATOMIC_ACQUIRE) && 0 == paralexeclist_elastic_trylock(el)) {
+        if (seg == el->freeing) {
+            free(seg->base);
+            seg->base = 0;
+            __atomic_sub_fetch(&(el->segments), 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&(el->freeing), 0, __ATOMIC_RELEASE);
+        }
+        paralexeclist_elastic_unlock(el);
+    }
+
+    if (0 != ++paralexeclist_elastic_tick % PARALEXECLIST_RECLAIM_PERIOD) {
+        return;
+    }
+    now = paralexeclist_elastic_now_ms();
+
+    if ((seg = __atomic_load_n(&(el->retiring), __ATOMIC_ACQUIRE))) {
+        since = __atomic_load_n(&(el->low_since_ms), __ATOMIC_RELAXED);
+        if (now - since >= el->shrink_ms / 4 && __atomic_compare_exchange_n(
+                &(el->low_since_ms), &since, now, 0, __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED)) {
+            paralexeclist_elastic_sweep(plt, seg);
+        }
+        return;
+    }
+    if (0 == __atomic_load_n(&(el->segments), __ATOMIC_RELAXED)
+            || 0 != __atomic_load_n(&(el->freeing), __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // Surplus of idle elements is enough to release a segment and still
+    // leave one segment worth of idle elements
+    idle = __atomic_load_n(&(el->capacity), __ATOMIC_RELAXED)
+            - __atomic_load_n(&(el->in_use), __ATOMIC_RELAXED);
+    if (idle < 2 * el->seg_size) {
+        __atomic_store_n(&(el->low_since_ms), 0, __ATOMIC_RELAXED);
+        return;
+    }
+    since = 0;
+    if (__atomic_compare_exchange_n(&(el->low_since_ms), &since, now, 0,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED) || now - since < el->shrink_ms
+            || 0 != paralexeclist_elastic_trylock(el)) {
+        return;
+    }
+
+    seg = 0;
+    for (i = PARALEXECLIST_SEGMENTS_MAX - 1; i >= 0 && 0 == seg; i--) {
+        if (el->seg[i].base) {
+            seg = &(el->seg[i]);
+        }
+    }
+    if (seg && 0 == el->retiring && 0 == el->freeing) {
+        __atomic_sub_fetch(&(el->capacity), seg->count, __ATOMIC_RELAXED);
+        __atomic_store_n(&(el->low_since_ms), now, __ATOMIC_RELAXED);
+        __atomic_store_n(&(el->retiring), seg, __ATOMIC_RELEASE);
+    }
+    paralexeclist_elastic_unlock(el);
+
+    if (seg) {
+        paralexeclist_elastic_sweep(plt, seg);
+    }
+}
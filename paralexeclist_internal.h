@@ -0,0 +1,626 @@
+/*****************************************************************************
+ * paralexeclist_internal.h - Internals of parallel execution list shared by
+ *                            its translation units
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#ifndef PARALEXECLIST_INTERNAL_H_
+#define PARALEXECLIST_INTERNAL_H_
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "mpmc.h"
+#include "rdl.h"
+#include "paralexeclist.h"
+
+/*
+ * Times to retry on an empty list before parking
+ */
+#define PARALEXECLIST_SPIN_TRIES    64
+
+/*
+ * Maximum number of elements consumed in one batch
+ */
+#define PARALEXECLIST_BATCH_MAX     64
+
+/*
+ * Internal result of paralexeclist_waiter_next telling waiter to park
+ */
+#define PARALEXECLIST_WAIT_PARK     3
+
+/*
+ * Wait/wake words of a side of parallel execution list
+ */
+typedef struct paralexeclist_event {
+    unsigned int seq;       // Futex word, bumped after every add
+    unsigned int waiters;   // Number of parked threads
+} paralexeclist_event;
+
+/*
+ * State of a thread waiting on a side of parallel execution list
+ */
+typedef struct paralexeclist_waiter {
+    int timeout_ms;
+    int tries;
+    const int *cancel;      // Give up waiting once it is set, or 0
+    struct timespec deadline;
+    struct timespec remain;
+} paralexeclist_waiter;
+
+/*
+ * Size of cache line, on which hot fields of the list are separated
+ */
+#define PARALEXECLIST_CACHE_LINE    64
+#define __cacheline_aligned         \
+        __attribute__((aligned(PARALEXECLIST_CACHE_LINE)))
+
+/*
+ * Magic number of an initialized shared part of parallel execution list
+ */
+#define PARALEXECLIST_MAGIC         0x50454c31
+
+/*
+ * Maximum number of enrolled shards
+ */
+#define PARALEXECLIST_SHARDS_MAX    1024
+
+/*
+ * Maximum number of priority lanes
+ */
+#define PARALEXECLIST_LANES_MAX     16
+
+/*
+ * Default number of data a consumer takes from higher lanes in a row,
+ * while a lower one is not empty, before it takes one from the lowest
+ */
+#define PARALEXECLIST_PRIO_QUOTA    16
+
+/*
+ * Maximum number of pipeline stages
+ */
+#define PARALEXECLIST_STAGES_MAX    8
+
+/*
+ * Maximum number of NUMA nodes with an idle pool of their own
+ */
+#define PARALEXECLIST_NODES_MAX     8
+
+/*
+ * Size of huge pages lists are rounded up to with PARALEXECLIST_ATTR_HUGEPAGE
+ */
+#define PARALEXECLIST_HUGE_PAGE     (2UL << 20)
+
+/*
+ * Maximum number of key slots of keyed data
+ */
+#define PARALEXECLIST_KEYS_MAX      4096
+
+/*
+ * Number of exchange slots handing elements from consumers to producers
+ */
+#define PARALEXECLIST_EXCHANGE_SLOTS    8
+
+/*
+ * Spin-wait hints a producer waits on an exchange slot for an element
+ */
+#define PARALEXECLIST_EXCHANGE_SPINS    128
+
+/*
+ * Values of an exchange slot other than the offset of an element handed
+ * over, from shared part of list
+ */
+#define PARALEXECLIST_EXCHANGE_FREE     0
+#define PARALEXECLIST_EXCHANGE_WAITING  1   // A producer waits on it
+
+/*
+ * Exchange slot, on a cache line of its own
+ */
+typedef struct paralexeclist_exchange {
+    ptrdiff_t slot __cacheline_aligned;
+} paralexeclist_exchange;
+
+/*
+ * Timer wheel of PARALEXECLIST_ATTR_TIMERS: levels of slots, a slot of
+ * level l spanning 2^(l * PARALEXECLIST_WHEEL_BITS) ticks of a millisecond
+ */
+#define PARALEXECLIST_WHEEL_LEVELS  4
+#define PARALEXECLIST_WHEEL_BITS    6
+#define PARALEXECLIST_WHEEL_SLOTS   (1 << PARALEXECLIST_WHEEL_BITS)
+
+/*
+ * State of the timer wheel, times in milliseconds of CLOCK_MONOTONIC
+ */
+typedef struct paralexeclist_wheel {
+    unsigned long tick;     // Last tick visited
+    unsigned long next;     // No slot to visit before it
+    int count;              // Data filed in slots
+    int lock;               // Taken to advance the wheel
+} paralexeclist_wheel;
+
+/*
+ * Head of an enrolled shard, of a key slot, or of the idle pool of a node,
+ * on a cache line of its own
+ */
+typedef struct paralexeclist_shard {
+    rdl list __cacheline_aligned;
+    int busy;               // Key slot claimed by a consumer
+} paralexeclist_shard;
+
+/*
+ * Number of counter slots, threads share slot of their index modulo it
+ */
+#define PARALEXECLIST_STATS_SLOTS   64
+
+/*
+ * Number of operations of a thread between samples of depth
+ */
+#define PARALEXECLIST_STATS_SAMPLE  64
+
+/*
+ * Counters of threads of one slot, on cache lines of their own
+ */
+typedef struct paralexeclist_stats_slot {
+    unsigned long produced;
+    unsigned long consumed;
+    unsigned long retries;
+    unsigned long exchanged;
+    rdl_stats rdl;
+} __cacheline_aligned paralexeclist_stats_slot;
+
+/*
+ * Job carried by an element with PARALEXECLIST_ATTR_JOBS, right after its
+ * rdl_element. A routine of 0 means the element carries plain data for
+ * the list's consume routine.
+ */
+typedef struct paralexeclist_job {
+    void (*routine)(void *);
+    char payload[];         // Aligned as a pointer
+} paralexeclist_job;
+
+/*
+ * Job of an element with PARALEXECLIST_ATTR_JOBS
+ * Parameters:  e   - Element carrying the job
+ */
+#define paralexeclist_job_of(e)    ((paralexeclist_job *) ((rdl_element *) \
+                                        (e) + 1))
+
+/*
+ * Element carrying a job payload
+ * Parameters:  p   - Payload of the job
+ */
+#define paralexeclist_payload_elmt(p)                                       \
+                                    ((rdl_element *) ((char *) (p)          \
+                                        - offsetof(paralexeclist_job,       \
+                                            payload)) - 1)
+
+/*
+ * Memory length of the job of an element, payload rounded up to a pointer
+ * Parameters:  payload_size    - Inline payload bytes of each element
+ */
+#define paralexeclist_job_len(payload_size)                                 \
+                                    (sizeof(paralexeclist_job)              \
+                                        + (((payload_size)                  \
+                                            + sizeof(void *) - 1)           \
+                                            & ~(sizeof(void *) - 1)))
+
+/*
+ * States of data with a ticket, the futex word its waiter sleeps on. The
+ * bits above count generations of tickets handed out on the element, and
+ * go in the high half of the ticket, so that a ticket spent is refused
+ * once its element carries other data.
+ */
+#define PARALEXECLIST_TICKET_PENDING    1
+#define PARALEXECLIST_TICKET_DONE       2
+#define PARALEXECLIST_TICKET_DROP       3
+#define PARALEXECLIST_TICKET_STATE      3   // Mask of the states above
+#define PARALEXECLIST_TICKET_WAITING    4   // Or-ed while a waiter sleeps
+#define PARALEXECLIST_TICKET_GEN        8   // Unit of generation count
+
+/*
+ * Generation bits of a ticket state
+ * Parameters:  state   - State of data with a ticket
+ */
+#define paralexeclist_ticket_gen(state)                                     \
+                                    ((state)                                \
+                                        & ~(PARALEXECLIST_TICKET_GEN - 1))
+
+/*
+ * Completion state carried by an element with PARALEXECLIST_ATTR_TICKETS,
+ * after its job if any. A state of 0, generation aside, means the element
+ * has no ticket.
+ */
+typedef struct paralexeclist_done {
+    unsigned int state;
+    long result;
+} paralexeclist_done;
+
+/*
+ * Due tick of an element with PARALEXECLIST_ATTR_TIMERS, after its
+ * completion state if any
+ * Parameters:  plt - The list
+ *              e   - Element carrying the tick
+ */
+#define paralexeclist_due_of(plt, e)                                        \
+                                    ((unsigned long *) ((char *) (e)        \
+                                        + (plt)->due_off))
+
+/*
+ * Completion state of an element with PARALEXECLIST_ATTR_TICKETS
+ * Parameters:  plt - The list
+ *              e   - Element carrying the state
+ */
+#define paralexeclist_done_of(plt, e)                                       \
+                                    ((paralexeclist_done *) ((char *) (e)   \
+                                        + (plt)->done_off))
+
+/*
+ * Shared part of parallel execution list, which holds no absolute address
+ * so that processes can map it anywhere. The idle heads, the events and
+ * the exchange slots are each on their own cache line, enrolled shards
+ * follow it, lane by lane from the lowest, then stage by stage after the
+ * first as lanes above the highest, then key slots, then wheel slots with
+ * PARALEXECLIST_ATTR_TIMERS, level by level, then counter slots with
+ * PARALEXECLIST_ATTR_STATS, then elements, in one pool per node. With
+ * PARALEXECLIST_ATTR_NUMA on several nodes, pools start on page boundaries
+ * so each can be bound to its node.
+ * With PARALEXECLIST_ATTR_RING, the ring takes place of the heads, and its
+ * slots follow it instead; idle_ev then tells the ring is no more full.
+ */
+typedef struct paralexeclist_shared {
+    unsigned int magic;     // Set last on creation
+    int flags;
+    int list_size;
+    size_t mem_len;
+    int shards;             // Number of enrolled lists, of all lanes
+    int keys;               // Number of key slots
+    int lanes;              // Number of priority lanes
+    int stages;             // Number of pipeline stages
+    int prio_quota;
+    int payload_size;       // Inline payload bytes of each element
+    int nodes;              // Number of idle pools
+    size_t elmts;           // Offset of elements from shared part
+    size_t pool_len;        // Memory length of the pool of a node
+    int el_size;            // Size of an element
+    unsigned long depth_max; // High-water of enrolled data
+    paralexeclist_event enrolled_ev __cacheline_aligned;
+    unsigned int prio_streak __cacheline_aligned;
+                            // Data taken from higher lanes in a row while
+                            // a lower one was not empty
+    unsigned int keyed __cacheline_aligned;
+                            // Keyed data enrolled, or about to be
+    unsigned int notified __cacheline_aligned;
+                            // Eventfd written since the last drain
+    paralexeclist_wheel wheel __cacheline_aligned;
+    paralexeclist_shard idle[PARALEXECLIST_NODES_MAX];
+    paralexeclist_event idle_ev __cacheline_aligned;
+    paralexeclist_exchange exchange[PARALEXECLIST_EXCHANGE_SLOTS];
+    mpmc ring __cacheline_aligned;
+} paralexeclist_shared;
+
+/*
+ * Number of wheel slots
+ * Parameters:  flags   - Flags of list
+ */
+#define paralexeclist_wheel_slots(flags)                                    \
+                                    ((flags) & PARALEXECLIST_ATTR_TIMERS    \
+                                        ? PARALEXECLIST_WHEEL_LEVELS        \
+                                            * PARALEXECLIST_WHEEL_SLOTS     \
+                                        : 0)
+
+/*
+ * Enrolled shards, key slots, wheel slots and counter slots following
+ * shared part of list
+ * Parameters:  sh  - Shared part of list
+ */
+#define paralexeclist_shard_at(sh) ((paralexeclist_shard *) ((sh) + 1))
+#define paralexeclist_key_at(sh)   (paralexeclist_shard_at(sh) + (sh)->shards)
+#define paralexeclist_wheel_at(sh) (paralexeclist_key_at(sh) + (sh)->keys)
+#define paralexeclist_stats_at(sh) ((paralexeclist_stats_slot *)           \
+                                        (paralexeclist_wheel_at(sh)         \
+                                            + paralexeclist_wheel_slots(    \
+                                                (sh)->flags)))
+
+/*
+ * Memory length of counter slots
+ * Parameters:  flags   - Flags of list
+ */
+#define paralexeclist_stats_len(flags)                                      \
+                                    ((flags) & PARALEXECLIST_ATTR_STATS     \
+                                        ? sizeof(paralexeclist_stats_slot)  \
+                                            * PARALEXECLIST_STATS_SLOTS     \
+                                        : 0)
+
+/*
+ * Maximum number of segments an elastic list grows by
+ */
+#define PARALEXECLIST_SEGMENTS_MAX  64
+
+/*
+ * Default time surplus of idle elements lasts before it is released
+ */
+#define PARALEXECLIST_SHRINK_MS     1000
+
+/*
+ * Operations on idle of an elastic list between checks for a segment to
+ * retire, as reading the clock on each would cost more than the check
+ */
+#define PARALEXECLIST_RECLAIM_PERIOD 64
+
+/*
+ * Segment of elements added to an elastic list
+ */
+typedef struct paralexeclist_segment {
+    void *base;             // Memory of elements, 0 if slot is free
+    int count;              // Number of elements
+    int collected;          // Elements taken out of circulation on retire
+} paralexeclist_segment;
+
+/*
+ * Elastic capacity of a process-local list. Operations on the rdl lists
+ * run inside an epoch, counted on the parity of epoch they entered, so a
+ * collected segment is only freed once operations of the epoch it was
+ * collected in have left.
+ */
+typedef struct paralexeclist_elastic {
+    int max_size;
+    int seg_size;           // Elements per new segment
+    int el_size;
+    int shrink_ms;
+    int capacity;           // Elements in circulation
+    int in_use;             // Elements out of idle
+    int lock;               // Taken to grow, retire or free segments
+    int segments;           // Slots in use
+    paralexeclist_segment *retiring;
+    paralexeclist_segment *freeing;
+    int freeing_parity;
+    long low_since_ms;      // Surplus of idle began, 0 if none, or last
+                            // sweep of idle while retiring
+    unsigned int epoch __cacheline_aligned;
+    unsigned int active[2] __cacheline_aligned;
+    paralexeclist_segment seg[PARALEXECLIST_SEGMENTS_MAX];
+} paralexeclist_elastic;
+
+/*
+ * Parallel execution list, a process-local handle of the shared part
+ */
+typedef struct paralexeclist {
+    paralexeclist_shared *shared;
+    rdl** enrolled;         // Enrolled shards, lane by lane, then stage
+                            // by stage
+    int shards;             // Number of enrolled shards per lane
+    int lanes;
+    int stages;
+    void (*stage_handle[PARALEXECLIST_STAGES_MAX])(void *);
+                            // Routines of stages after the first
+    paralexeclist_shard *keyed;         // Key slots
+    int keys;
+    int key_base;           // Id of list of the first key slot
+    paralexeclist_shard *wheel;         // Wheel slots, level by level
+    rdl* idle[PARALEXECLIST_NODES_MAX];    // Idle pool of each node
+    int nodes;
+    paralexeclist_event *enrolled_ev;
+    paralexeclist_event *idle_ev;
+    void (*job_handle)(void *);
+    void (*batch_handle)(void **, int);
+    int flags;
+    int payload_size;
+    int done_off;           // Offset of completion state in an element
+    int due_off;            // Offset of due tick in an element
+    int overflow;           // Policy when idle is empty
+    int overflow_ms;
+    void (*overflow_routine)(void *);
+    rdl_backoff_policy backoff;         // Backoff on contention
+    unsigned int backoff_limit;
+    char *shm_name;         // Name to unlink, set on the creating process
+    int efd;                // Eventfd of PARALEXECLIST_ATTR_EVENTFD, or -1
+    struct paralexeclist_workers *workers;
+    paralexeclist_stats_slot *stats;    // Counter slots, or 0
+    paralexeclist_elastic *elastic;     // Elastic capacity, or 0
+} paralexeclist;
+
+/*
+ * Number of events of the trace buffer of a thread, a power of two
+ */
+#define PARALEXECLIST_TRACE_EVENTS  16384
+
+/*
+ * Points of the life of data stamped with PARALEXECLIST_ATTR_TRACE
+ */
+typedef enum paralexeclist_trace_point {
+    PARALEXECLIST_TRACE_ENROLL  = 1,    // Element about to be enrolled
+    PARALEXECLIST_TRACE_TAKE    = 2,    // Element won by a consumer
+    PARALEXECLIST_TRACE_RUN     = 3,    // Routine, or batch routine, called
+    PARALEXECLIST_TRACE_DONE    = 4,    // Routine returned
+    PARALEXECLIST_TRACE_RETRY   = 5     // Operation retried on contention
+} paralexeclist_trace_point;
+
+/*
+ * Event of a trace buffer. id is the offset of the element from shared part
+ * of list, or trylock failures of a retry; arg is the stage of a run, data
+ * of a batch, or operations retried.
+ */
+typedef struct paralexeclist_trace_event {
+    unsigned long tsc;
+    unsigned long id;
+    unsigned int arg;
+    unsigned short point;
+    int tid;
+} paralexeclist_trace_event;
+
+/*
+ * Trace buffer of a thread, a ring only that thread writes to. Events of
+ * index below head - PARALEXECLIST_TRACE_EVENTS were overwritten. A buffer
+ * left by an exited thread goes to the next thread starting to trace.
+ */
+typedef struct paralexeclist_trace {
+    unsigned long head;     // Index of next event, published after it
+    int tid;
+    int left;               // Thread exited
+    struct paralexeclist_trace *next;
+    paralexeclist_trace_event events[PARALEXECLIST_TRACE_EVENTS];
+} paralexeclist_trace;
+
+extern __thread paralexeclist_trace *paralexeclist_trace_local;
+
+/*
+ * Ticks of the trace clock, the time stamp counter where there is one.
+ */
+static inline unsigned long paralexeclist_trace_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000UL + now.tv_nsec;
+#endif
+}
+
+/*
+ *  Description: Take a trace buffer for the calling thread.
+ * Return value: On success returns the buffer; on error, it returns 0.
+ */
+extern paralexeclist_trace *paralexeclist_trace_open(void);
+
+/*
+ * Stamp a point of list with PARALEXECLIST_ATTR_TRACE in the buffer of the
+ * calling thread.
+ */
+static inline void paralexeclist_trace_stamp(paralexeclist *plt, int point,
+        unsigned long id, unsigned int arg) {
+    paralexeclist_trace *t = paralexeclist_trace_local;
+    paralexeclist_trace_event *ev;
+
+    if (0 == (plt->flags & PARALEXECLIST_ATTR_TRACE)
+            || (0 == t && 0 == (t = paralexeclist_trace_open()))) {
+        return;
+    }
+
+    ev = &(t->events[t->head & (PARALEXECLIST_TRACE_EVENTS - 1)]);
+    ev->tsc = paralexeclist_trace_clock();
+    ev->id = id;
+    ev->arg = arg;
+    ev->point = point;
+    ev->tid = t->tid;
+    __atomic_store_n(&(t->head), t->head + 1, __ATOMIC_RELEASE);
+}
+
+static inline long paralexeclist_futex(unsigned int *uaddr, int op,
+        unsigned int val, const struct timespec *timeout) {
+    return syscall(SYS_futex, uaddr, op, val, timeout, 0, 0);
+}
+
+/*
+ * Wake up to count threads parked on the event, if any.
+ */
+static inline void paralexeclist_signal(paralexeclist_event *ev, int count) {
+    __atomic_add_fetch(&(ev->seq), 1, __ATOMIC_SEQ_CST);
+    if (0 != __atomic_load_n(&(ev->waiters), __ATOMIC_SEQ_CST)) {
+        paralexeclist_futex(&(ev->seq), FUTEX_WAKE, count, 0);
+    }
+}
+
+/*
+ *  Description: Start waiting on a side of parallel execution list.
+ *    Parameter: w          - Waiter to initialize.
+ *               timeout_ms - Timeout, 0 never waits, negative waits forever.
+ *               cancel     - Give up waiting once it is set, or 0.
+ */
+extern void paralexeclist_waiter_init(paralexeclist_waiter *w, int timeout_ms,
+        const int *cancel);
+
+/*
+ *  Description: Account an operation on the rdl lists, in counters of list
+ *               with PARALEXECLIST_ATTR_STATS, and as retries in the trace
+ *               buffer with PARALEXECLIST_ATTR_TRACE.
+ *    Parameter: plt        - Parallel execution list.
+ *               st         - Lock failures of the operation.
+ *               retries    - Times the operation was retried.
+ *               produced   - Elements it enrolled.
+ *               consumed   - Elements it gave back to idle.
+ */
+extern void paralexeclist_account(paralexeclist *plt, const rdl_stats *st,
+        unsigned long retries, unsigned long produced,
+        unsigned long consumed);
+
+/*
+ *  Description: Consuming data on parallel execution list.
+ *    Parameter: plt        - Parallel execution list.
+ *               w          - Waiter to wait for data with.
+ * Return value: On success returns 0; if list is empty and waiter gives up,
+ *               it returns PARALEXECLIST_RET_EMPTY or
+ *               PARALEXECLIST_RET_TIMEOUT; on error, it returns -1.
+ */
+extern int paralexeclist_consume_wait(paralexeclist *plt,
+        paralexeclist_waiter *w);
+
+/*
+ * Enter an epoch before walking rdl lists of elastic list, returns the
+ * parity to leave.
+ */
+static inline int paralexeclist_elastic_enter(paralexeclist_elastic *el) {
+    unsigned int epoch;
+
+    while (1) {
+        epoch = __atomic_load_n(&(el->epoch), __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&(el->active[epoch & 1]), 1, __ATOMIC_SEQ_CST);
+        if (epoch == __atomic_load_n(&(el->epoch), __ATOMIC_SEQ_CST)) {
+            return epoch & 1;
+        }
+        __atomic_sub_fetch(&(el->active[epoch & 1]), 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static inline void paralexeclist_elastic_leave(paralexeclist_elastic *el,
+        int parity) {
+    __atomic_sub_fetch(&(el->active[parity]), 1, __ATOMIC_RELEASE);
+}
+
+/*
+ *  Description: Make list elastic, with the elements of its shared part as
+ *               first segment that is never released.
+ *    Parameter: plt        - Parallel execution list.
+ *               el_size    - Size of element.
+ *               attr       - Attributes.
+ * Return value: On success returns 0; on error, it returns -1.
+ */
+extern int paralexeclist_elastic_init(paralexeclist *plt, int el_size,
+        const paralexeclist_attr *attr);
+
+/*
+ *  Description: Free segments of elastic list.
+ *    Parameter: plt        - Parallel execution list.
+ */
+extern void paralexeclist_elastic_free(paralexeclist *plt);
+
+/*
+ *  Description: Append a segment of new elements to idle of elastic list.
+ *    Parameter: plt        - Parallel execution list.
+ * Return value: If a segment was added, or another thread is adding one,
+ *               returns 0; if list reached its ceiling, it returns -1.
+ */
+extern int paralexeclist_elastic_grow(paralexeclist *plt);
+
+/*
+ *  Description: Take elements of the retiring segment out of a chain of
+ *               elements just taken from or about to be given to idle, and
+ *               account elements in use.
+ *    Parameter: plt        - Parallel execution list.
+ *               first      - First element of chain, updated.
+ *               last       - Last element of chain, updated.
+ *               count      - Number of elements of chain, updated.
+ *               taken      - Chain was taken from idle, not given to it.
+ */
+extern void paralexeclist_elastic_filter(paralexeclist *plt,
+        rdl_element **first, rdl_element **last, int *count, int taken);
+
+/*
+ *  Description: Retire a segment if idle elements stayed in surplus, and
+ *               free a collected segment once no operation can see it.
+ *               Called outside of any epoch.
+ *    Parameter: plt        - Parallel execution list.
+ */
+extern void paralexeclist_elastic_reclaim(paralexeclist *plt);
+
+#endif /* PARALEXECLIST_INTERNAL_H_ */
@@ -0,0 +1,199 @@
+/*****************************************************************************
+ * paralexeclist_trace.c - Tracing of data through parallel execution list
+ *
+ * Buffers: every thread stamps events into a ring of its own, with no lock
+ * nor system call, and publishes each by bumping head. A dump copies a ring
+ * while its thread may still write, then drops the events that thread
+ * could have overwritten meanwhile:
+ *  |       Thread          |       Dump                        |
+ *  |  ev[h % N] = event    |  h1 = head                        |
+ *  |  head = h + 1         |  copy ev[max(h1 - N, 0) .. h1]    |
+ *  |                       |  h2 = head                        |
+ *  |                       |  drop those below h2 - N + 1      |
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "paralexeclist_internal.h"
+
+__thread paralexeclist_trace *paralexeclist_trace_local;
+
+static paralexeclist_trace *paralexeclist_traces;  // Buffers of process
+static pthread_once_t paralexeclist_trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t paralexeclist_trace_key;
+static unsigned long paralexeclist_trace_tsc0;     // Clock at first buffer
+static unsigned long paralexeclist_trace_ns0;
+
+static unsigned long paralexeclist_trace_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+/*
+ * Leave the buffer of an exiting thread to the next thread starting to
+ * trace, its events kept until overwritten.
+ */
+static void paralexeclist_trace_leave(void *arg) {
+    paralexeclist_trace *t = (paralexeclist_trace *) arg;
+    __atomic_store_n(&(t->left), 1, __ATOMIC_RELEASE);
+}
+
+static void paralexeclist_trace_init(void) {
+    pthread_key_create(&paralexeclist_trace_key, paralexeclist_trace_leave);
+    paralexeclist_trace_ns0 = paralexeclist_trace_now_ns();
+    paralexeclist_trace_tsc0 = paralexeclist_trace_clock();
+}
+
+extern paralexeclist_trace *paralexeclist_trace_open(void) {
+    paralexeclist_trace *t;
+    int left;
+
+    pthread_once(&paralexeclist_trace_once, paralexeclist_trace_init);
+
+    for (t = __atomic_load_n(&paralexeclist_traces, __ATOMIC_ACQUIRE); t;
+            t = t->next) {
+        left = 1;
+        if (__atomic_load_n(&(t->left), __ATOMIC_RELAXED)
+                && __atomic_compare_exchange_n(&(t->left), &left, 0, 0,
+                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (0 == t) {
+        if (0 == (t = (paralexeclist_trace *) calloc(1,
+                sizeof(paralexeclist_trace)))) {
+            return 0;
+        }
+        t->next = __atomic_load_n(&paralexeclist_traces, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&paralexeclist_traces,
+                &(t->next), t, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    t->tid = syscall(SYS_gettid);
+    pthread_setspecific(paralexeclist_trace_key, t);
+    paralexeclist_trace_local = t;
+    return t;
+}
+
+/*
+ * Nanoseconds per tick of the trace clock, measured against the monotonic
+ * clock since the first buffer, over a millisecond at least.
+ */
+static double paralexeclist_trace_ns_per_tick(void) {
+    unsigned long ns, tsc;
+
+    do {
+        ns = paralexeclist_trace_now_ns();
+        tsc = paralexeclist_trace_clock();
+    } while (ns - paralexeclist_trace_ns0 < 1000000UL);
+
+    if (tsc <= paralexeclist_trace_tsc0) {
+        return 1.0;
+    }
+    return (double) (ns - paralexeclist_trace_ns0)
+            / (tsc - paralexeclist_trace_tsc0);
+}
+
+/*
+ * Write an event in Chrome trace format, returns 0 if one was written.
+ */
+static int paralexeclist_trace_write(FILE *out,
+        const paralexeclist_trace_event *ev, int pid, double ns_per_tick,
+        int first) {
+    double ts = (double) (long) (ev->tsc - paralexeclist_trace_tsc0)
+            * ns_per_tick / 1000.0;
+    const char *sep = first ? "" : ",\n";
+
+    switch (ev->point) {
+    case PARALEXECLIST_TRACE_ENROLL:
+    case PARALEXECLIST_TRACE_TAKE:
+        fprintf(out, "%s{\"name\":\"queued\",\"cat\":\"paralexeclist\","
+                "\"ph\":\"%s\",\"id\":\"0x%lx\",\"pid\":%d,\"tid\":%d,"
+                "\"ts\":%.3f}", sep,
+                PARALEXECLIST_TRACE_ENROLL == ev->point ? "b" : "e",
+                ev->id, pid, ev->tid, ts);
+        return 0;
+    case PARALEXECLIST_TRACE_RUN:
+        fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"paralexeclist\","
+                "\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+                "\"args\":{\"%s\":%u,\"element\":\"0x%lx\"}}", sep,
+                ev->id ? "run" : "batch", pid, ev->tid, ts,
+                ev->id ? "stage" : "count", ev->arg, ev->id);
+        return 0;
+    case PARALEXECLIST_TRACE_DONE:
+        fprintf(out, "%s{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+                sep, pid, ev->tid, ts);
+        return 0;
+    case PARALEXECLIST_TRACE_RETRY:
+        fprintf(out, "%s{\"name\":\"retry\",\"cat\":\"paralexeclist\","
+                "\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,"
+                "\"ts\":%.3f,\"args\":{\"retries\":%u,"
+                "\"trylock_fail\":%lu}}", sep, pid, ev->tid, ts, ev->arg,
+                ev->id);
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+extern int paralexeclist_trace_dump(const char *path) {
+    if (0 == path) {
+        return -1;
+    }
+
+    paralexeclist_trace_event *copy;
+    paralexeclist_trace *t;
+    unsigned long h1, h2, from, i;
+    double ns_per_tick;
+    int pid = getpid(), first = 1;
+    FILE *out;
+
+    if (0 == (copy = (paralexeclist_trace_event *) malloc(
+            sizeof(paralexeclist_trace_event) * PARALEXECLIST_TRACE_EVENTS))) {
+        return -1;
+    }
+    if (0 == (out = fopen(path, "w"))) {
+        free(copy);
+        return -1;
+    }
+
+    pthread_once(&paralexeclist_trace_once, paralexeclist_trace_init);
+    ns_per_tick = paralexeclist_trace_ns_per_tick();
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (t = __atomic_load_n(&paralexeclist_traces, __ATOMIC_ACQUIRE); t;
+            t = t->next) {
+        h1 = __atomic_load_n(&(t->head), __ATOMIC_ACQUIRE);
+        from = h1 > PARALEXECLIST_TRACE_EVENTS
+                ? h1 - PARALEXECLIST_TRACE_EVENTS : 0;
+        for (i = from; i < h1; i++) {
+            copy[i & (PARALEXECLIST_TRACE_EVENTS - 1)]
+                    = t->events[i & (PARALEXECLIST_TRACE_EVENTS - 1)];
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        h2 = __atomic_load_n(&(t->head), __ATOMIC_ACQUIRE);
+        if (h2 >= PARALEXECLIST_TRACE_EVENTS
+                && from < h2 - PARALEXECLIST_TRACE_EVENTS + 1) {
+            from = h2 - PARALEXECLIST_TRACE_EVENTS + 1;
+        }
+
+        for (i = from; i < h1; i++) {
+            if (0 == paralexeclist_trace_write(out,
+                    &(copy[i & (PARALEXECLIST_TRACE_EVENTS - 1)]), pid,
+                    ns_per_tick, first)) {
+                first = 0;
+            }
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    free(copy);
+    return 0 == fclose(out) ? 0 : -1;
+}
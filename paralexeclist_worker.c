@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * paralexeclist_worker.c - Worker threads consuming parallel execution list
+ *
+ * Stop: drain sets stopping and wakes every parked consumer. A worker only
+ * looks at stopping once it found the list empty, so jobs enrolled before
+ * the drain still run, and it gives up instead of parking again:
+ *  |       Worker          |       Drain           |
+ *  |  waiters++            |  stopping = 1         |
+ *  |  s = seq              |  seq++                |
+ *  |  if (empty && !stop)  |  if (waiters)         |
+ *  |    futex_wait(seq, s) |    futex_wake(seq, *) |
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "paralexeclist_internal.h"
+
+/*
+ * Worker threads of a parallel execution list
+ */
+typedef struct paralexeclist_workers {
+    paralexeclist *plt;
+    int stopping;           // Set once drain started
+    int aborting;           // Set to stop without draining
+    int count;
+    pthread_t threads[];
+} paralexeclist_workers;
+
+static void *paralexeclist_worker(void *arg) {
+    paralexeclist_workers *wk = (paralexeclist_workers *) arg;
+    paralexeclist_waiter w;
+
+    do {
+        if (__atomic_load_n(&(wk->aborting), __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        paralexeclist_waiter_init(&w, -1, &(wk->stopping));
+    } while (0 == paralexeclist_consume_wait(wk->plt, &w));
+
+    return 0;
+}
+
+/*
+ * Pin thread attributes to the index-th CPU of set, wrapping around it.
+ */
+static int paralexeclist_worker_affinity(pthread_attr_t *attr,
+        const cpu_set_t *cpus, int index) {
+    int count = CPU_COUNT(cpus);
+    int cpu;
+    cpu_set_t one;
+
+    if (0 == count) {
+        return -1;
+    }
+
+    index %= count;
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, cpus) && 0 == index--) {
+            break;
+        }
+    }
+
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    return 0 == pthread_attr_setaffinity_np(attr, sizeof(one), &one) ? 0 : -1;
+}
+
+/*
+ * Stop workers of list once they find it empty, or after the job at hand
+ * if aborting, and wait for them to exit.
+ */
+static int paralexeclist_workers_stop(paralexeclist *plt) {
+    paralexeclist_workers *wk = plt->workers;
+    int i, ret = 0;
+
+    __atomic_store_n(&(wk->stopping), 1, __ATOMIC_SEQ_CST);
+    paralexeclist_signal(plt->enrolled_ev, INT_MAX);
+
+    for (i = 0; i < wk->count; i++) {
+        if (0 != pthread_join(wk->threads[i], 0)) {
+            ret = -1;
+        }
+    }
+
+    plt->workers = 0;
+    free(wk);
+    return ret;
+}
+
+extern int paralexeclist_start_workers(paralexeclist_t list, int n,
+        const cpu_set_t *cpus) {
+    if (0 == list || n <= 0) {
+        return -1;
+    }
+
+    paralexeclist *plt = (paralexeclist *) list;
+    paralexeclist_workers *wk;
+    pthread_attr_t attr;
+    int i;
+
+    // Workers park on an empty list, which only producers of a list with
+    // PARALEXECLIST_ATTR_PARK wake them from
+    if (0 != plt->workers || 0 == (plt->flags & PARALEXECLIST_ATTR_PARK)) {
+        return -1;
+    }
+    if (0 == (wk = (paralexeclist_workers *) calloc(1,
+            sizeof(paralexeclist_workers) + sizeof(pthread_t) * n))) {
+        return -1;
+    }
+    wk->plt = plt;
+
+    if (0 != pthread_attr_init(&attr)) {
+        free(wk);
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        if ((cpus && 0 != paralexeclist_worker_affinity(&attr, cpus, i))
+                || 0 != pthread_create(&(wk->threads[i]), &attr,
+                        paralexeclist_worker, wk)) {
+            break;
+        }
+        wk->count++;
+    }
+    pthread_attr_destroy(&attr);
+
+    plt->workers = wk;
+    if (wk->count < n) {
+        // Leave jobs enrolled to the caller, not to the workers started
+        __atomic_store_n(&(wk->aborting), 1, __ATOMIC_RELEASE);
+        paralexeclist_workers_stop(plt);
+        return -1;
+    }
+
+    return 0;
+}
+
+extern int paralexeclist_drain_and_stop(paralexeclist_t list) {
+    if (0 == list || 0 == ((paralexeclist *) list)->workers) {
+        return -1;
+    }
+
+    return paralexeclist_workers_stop((paralexeclist *) list);
+}
@@ -14,13 +14,13 @@
  *  |  unlock(a.next)       |                       |
  *  |  b.prev = ?           |                       |
  *  |  b.next = ?           |                       |
- *  |  b.data = NULL        |                       |
+ *  |  b.owner = idle       |                       |
  *  |  unlock(b)            |                       |
  *  Enrolled: h -> a -> c -> h && h <- a <- c <- h
  *  Idle: h -> f -> b -> g -> h && h <- f <- b <- g <- h
  *  |                       |  lock(b.next)         |
  *  |                       |  memory barrier       |
- *  |                       |  if(b.data == NULL){  |
+ *  |                       |  if(b.owner!=enrolled)|
  *  |                       |    p = enrolled.h     |
  *  |                       |  } else {             |
  *  |                       |    lock(g)            |
@@ -38,24 +38,25 @@
 /*
  * Remove element start from the head of rounded double-linked list.
  */
-inline rdl_result rdl_remove(rdl *rdl, rdl_element **elmt) {
+extern rdl_result rdl_remove(rdl *rdl, rdl_element **elmt, rdl_stats *st,
+        rdl_backoff *bo) {
     rdl_result ret = RDL_RET_FAIL;
-    rdl_element *h = rdl->head;
+    rdl_element *h = rdl_head(rdl);
     rdl_element *p = h;
     rdl_element *l, *e;
 
     while (p) {
-        if (h == h->next) {
+        if (h == rdl_next(h)) {
             break;
         }
 
         if (0 == rdl_trylock_next(&(p->lock))) {
             l = p;  // Left bound
             if (0 == rdl_element_match(rdl, l)) {
-                p = p->next;
+                p = rdl_next(p);
                 if (p != h && 0 == rdl_trylock_elmt_n(&(p->lock), 2)) {
                     e = p;  // Selected element
-                    p = p->next;  // Right bound
+                    p = rdl_next(p);  // Right bound
                     if (0 == rdl_trylock_prev_n(&(p->lock), 4)) {
                         rdl_remove_elmt(l, e, p);
                         ret = RDL_RET_SUCCESS;
@@ -63,13 +64,19 @@ inline rdl_result rdl_remove(rdl *rdl, rdl_element **elmt) {
                             return RDL_RET_ERROR;
                         }
                     } else {
+                        rdl_stats_add(st, trylock_fail_prev, 1);
                         if (0 != rdl_unlock_elmt(&(e->lock))) {
                             return RDL_RET_ERROR;
                         }
                     }
+                } else if (p != h) {
+                    rdl_stats_add(st, trylock_fail_elmt, 1);
                 }
 
-                p = l->next->next;
+                p = rdl_next(rdl_next(l));
+                if (RDL_RET_SUCCESS != ret) {
+                    rdl_stats_add(st, walked, 2);
+                }
             } else {
                 p = h;
             }
@@ -82,8 +89,12 @@ inline rdl_result rdl_remove(rdl *rdl, rdl_element **elmt) {
                 *elmt = e;
                 return ret;
             }
+            rdl_backoff_wait(bo);   // Locks released
         } else {
-            p = p->next->next;
+            rdl_stats_add(st, trylock_fail_next, 1);
+            rdl_backoff_wait(bo);
+            rdl_stats_add(st, walked, 2);
+            p = rdl_next(rdl_next(p));
         }
     }
 
@@ -93,25 +104,93 @@ inline rdl_result rdl_remove(rdl *rdl, rdl_element **elmt) {
 /*
  * Add element start from the tail of rounded double-linked list.
  */
-inline rdl_result rdl_add(rdl *rdl, rdl_element *elmt) {
+extern rdl_result rdl_add(rdl *rdl, rdl_element *elmt, rdl_stats *st,
+        rdl_backoff *bo) {
     rdl_result ret = RDL_RET_FAIL;
-    rdl_element *h = rdl->head;
+    rdl_element *h = rdl_head(rdl);
     rdl_element *p = h;
     rdl_element *r;
 
     while (p) {
         if (0 == rdl_trylock_prev(&(p->lock))) {
             r = p;  // Right bound
-            p = p->prev;  // Left bound
-            if (0 == rdl_trylock_next(&(p->lock))) {
-                rdl_add_elmt(p, elmt, r);
-                ret = RDL_RET_SUCCESS;
-                if (0 != rdl_unlock_elmt(&(elmt->lock))) {
-                    return RDL_RET_ERROR;
+            if (0 == rdl_element_match(rdl, r)) {
+                p = rdl_prev(p);  // Left bound
+                if (0 == rdl_trylock_next(&(p->lock))) {
+                    elmt->owner = rdl->id;
+                    rdl_add_elmt(p, elmt, r);
+                    ret = RDL_RET_SUCCESS;
+                    if (0 != rdl_unlock_elmt(&(elmt->lock))) {
+                        return RDL_RET_ERROR;
+                    }
+                    if (0 != rdl_unlock_next(&(p->lock))) {
+                        return RDL_RET_ERROR;
+                    }
+                } else {
+                    rdl_stats_add(st, trylock_fail_next, 1);
                 }
-                if (0 != rdl_unlock_next(&(p->lock))) {
-                    return RDL_RET_ERROR;
+                p = rdl_prev(r);
+            } else {
+                p = h;
+            }
+
+            if (0 != rdl_unlock_prev(&(r->lock))) {
+                return RDL_RET_ERROR;
+            }
+
+            if (RDL_RET_SUCCESS == ret) {
+                return ret;
+            }
+            rdl_backoff_wait(bo);   // Locks released
+        } else {
+            rdl_stats_add(st, trylock_fail_prev, 1);
+            rdl_backoff_wait(bo);
+            p = rdl_prev(p);
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * Add chain of elements start from the tail of rounded double-linked list.
+ */
+extern rdl_result rdl_add_n(rdl *rdl, rdl_element *first, rdl_element *last,
+        rdl_stats *st, rdl_backoff *bo) {
+    rdl_result ret = RDL_RET_FAIL;
+    rdl_element *h = rdl_head(rdl);
+    rdl_element *p = h;
+    rdl_element *r, *e, *n;
+
+    while (p) {
+        if (0 == rdl_trylock_prev(&(p->lock))) {
+            r = p;  // Right bound
+            if (0 == rdl_element_match(rdl, r)) {
+                p = rdl_prev(p);  // Left bound
+                if (0 == rdl_trylock_next(&(p->lock))) {
+                    rdl_set_prev(first, p);
+                    rdl_set_next(last, r);
+                    rdl_set_next(p, first);
+                    rdl_set_prev(r, last);
+                    ret = RDL_RET_SUCCESS;
+                    e = first;
+                    while (e != r) {
+                        e->owner = rdl->id;
+                        n = rdl_next(e);  // Stable until e is unlocked
+                        if (0 != rdl_unlock_elmt(&(e->lock))) {
+                            return RDL_RET_ERROR;
+                        }
+                        e = n;
+                    }
+                    if (0 != rdl_unlock_next(&(p->lock))) {
+                        return RDL_RET_ERROR;
+                    }
+                } else {
+                    rdl_stats_add(st, trylock_fail_next, 1);
                 }
+                p = rdl_prev(r);
+            } else {
+                p = h;
             }
 
             if (0 != rdl_unlock_prev(&(r->lock))) {
@@ -121,9 +200,92 @@ inline rdl_result rdl_add(rdl *rdl, rdl_element *elmt) {
             if (RDL_RET_SUCCESS == ret) {
                 return ret;
             }
-            p = r->prev;
+            rdl_backoff_wait(bo);   // Locks released
+        } else {
+            rdl_stats_add(st, trylock_fail_prev, 1);
+            rdl_backoff_wait(bo);
+            p = rdl_prev(p);
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * Remove run of elements start from the head of rounded double-linked list.
+ */
+extern rdl_result rdl_remove_n(rdl *rdl, int max, rdl_element **first,
+        rdl_element **last, int *count, rdl_stats *st, rdl_backoff *bo) {
+    rdl_result ret = RDL_RET_FAIL;
+    rdl_element *h = rdl_head(rdl);
+    rdl_element *p = h;
+    rdl_element *l, *e;
+    int n;
+
+    while (p) {
+        if (h == rdl_next(h)) {
+            break;
+        }
+
+        if (0 == rdl_trylock_next(&(p->lock))) {
+            l = p;  // Left bound
+            if (0 == rdl_element_match(rdl, l)) {
+                p = rdl_next(p);
+                n = 0;
+                while (n < max && p != h
+                        && 0 == rdl_trylock_elmt_n(&(p->lock), 2)) {
+                    e = p;  // Last selected element
+                    p = rdl_next(p);
+                    n++;
+                }
+                if (0 == n && p != h) {
+                    rdl_stats_add(st, trylock_fail_elmt, 1);
+                }
+                if (n > 0) {
+                    // p is right bound
+                    if (0 == rdl_trylock_prev_n(&(p->lock), 4)) {
+                        *first = rdl_next(l);
+                        rdl_remove_elmt(l, *first, p);
+                        ret = RDL_RET_SUCCESS;
+                        if (0 != rdl_unlock_prev(&(p->lock))) {
+                            return RDL_RET_ERROR;
+                        }
+                    } else {
+                        rdl_stats_add(st, trylock_fail_prev, 1);
+                        p = rdl_next(l);
+                        while (n-- > 0) {
+                            e = p;
+                            p = rdl_next(p);
+                            if (0 != rdl_unlock_elmt(&(e->lock))) {
+                                return RDL_RET_ERROR;
+                            }
+                        }
+                    }
+                }
+
+                p = rdl_next(rdl_next(l));
+                if (RDL_RET_SUCCESS != ret) {
+                    rdl_stats_add(st, walked, 2);
+                }
+            } else {
+                p = h;
+            }
+
+            if (0 != rdl_unlock_next(&(l->lock))) {
+                return RDL_RET_ERROR;
+            }
+
+            if (RDL_RET_SUCCESS == ret) {
+                *last = e;
+                *count = n;
+                return ret;
+            }
+            rdl_backoff_wait(bo);   // Locks released
         } else {
-            p = p->prev;
+            rdl_stats_add(st, trylock_fail_next, 1);
+            rdl_backoff_wait(bo);
+            rdl_stats_add(st, walked, 2);
+            p = rdl_next(rdl_next(p));
         }
     }
 
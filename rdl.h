@@ -10,7 +10,9 @@
 
 #ifndef RDL_H_
 #define RDL_H_
+#include <stddef.h>
 #include "rdl_lock.h"
+#include "rdl_backoff.h"
 
 /*
  * Type of rounded double-linked list
@@ -30,52 +32,114 @@ typedef enum rdl_type {
 } rdl_type;
 
 /*
- * Element of rounded double-linked list
+ * Element of rounded double-linked list. Links are self-relative, the
+ * distance in bytes from the element to the one linked, so that a list
+ * stays valid wherever its memory is mapped.
  */
 typedef struct rdl_element {
-    struct rdl_element*         next;
-    struct rdl_element*         prev;
+    ptrdiff_t                   next;
+    ptrdiff_t                   prev;
     void*                       data;
-    char                        lock;
+    int                         owner;  // Id of list holding the element
+    rdl_lock                    lock;
 } rdl_element;
 
+/*
+ * Contention counters of rounded double-linked list operations
+ */
+typedef struct rdl_stats {
+    unsigned long               trylock_fail_next;
+    unsigned long               trylock_fail_prev;
+    unsigned long               trylock_fail_elmt;
+    unsigned long               walked; // Elements stepped over in remove
+} rdl_stats;
+
+/*
+ * Add to a contention counter
+ * Parameters:  st  - Counters, or 0 not to count
+ *              f   - Field of counter
+ *              n   - Value to add
+ */
+#define rdl_stats_add(st, f, n)    ({                                      \
+                                        if (st) {                           \
+                                            (st)->f += (n);                 \
+                                        }                                   \
+                                    })
+
 /*
  * Rounded double-linked list
  */
 typedef struct rdl {
-    rdl_element*                head;
     rdl_element                 nil;
     rdl_type                    type;
+    int                         id;     // Unique among lists sharing elements
 } rdl;
 
+/*
+ * Head of rounded double-linked list
+ * Parameters:  rdl - The rounded double-linked list
+ */
+#define rdl_head(rdl)              (&((rdl)->nil))
+
+/*
+ * Follow self-relative links of an element
+ * Parameters:  e   - Element to follow links of
+ */
+#define rdl_next(e)                ((rdl_element *) ((char *) (e) + (e)->next))
+#define rdl_prev(e)                ((rdl_element *) ((char *) (e) + (e)->prev))
+
+/*
+ * Set self-relative links of an element
+ * Parameters:  e   - Element to set links of
+ *              l   - Element to link
+ */
+#define rdl_set_next(e, l)         ((e)->next = (char *) (l) - (char *) (e))
+#define rdl_set_prev(e, l)         ((e)->prev = (char *) (l) - (char *) (e))
+
 /*
  * To test if an element belongs to the rounded double-linked list
  * Parameters:  rdl - The rounded double-linked list
  *              e   - Element to test
  */
 #define rdl_element_match(rdl, e)  (                                       \
-                                      ( ( (rdl)->type == RDL_TYPE_ENROLLED  \
-                                            && 0 != (e)->data               \
-                                        )                                   \
-                                        ||                                  \
-                                        ( (rdl)->type == RDL_TYPE_IDLE      \
-                                            && 0 == (e)->data               \
-                                        )                                   \
+                                      ( (rdl)->id == (e)->owner             \
                                         ||                                  \
-                                        (rdl)->head == (e)                  \
+                                        rdl_head(rdl) == (e)                \
                                       ) ? 0 : -1                            \
                                     )
 
+/*
+ * To test if rounded double-linked list is empty
+ * Parameters:  rdl - The rounded double-linked list
+ */
+#define rdl_empty(rdl)             (                                       \
+                                        0 == *(volatile ptrdiff_t *)        \
+                                                &((rdl)->nil.next)          \
+                                    )
+
 /*
  * Initialize rounded double-linked list head
  * Parameters:  h   - Head of rounded double-linked list
  */
 #define rdl_init_head(h)           ({                                      \
-                                        (h)->prev = (h);                    \
-                                        (h)->next = (h);                    \
+                                        (h)->prev = 0;                      \
+                                        (h)->next = 0;                      \
                                         (h)->data = 0;                      \
+                                        (h)->owner = -1;                    \
                                         (h)->lock = 0;                      \
                                     })
+
+/*
+ * Initialize rounded double-linked list
+ * Parameters:  rdl - The rounded double-linked list
+ *              t   - Type of list
+ *              i   - Id of list, unique among lists sharing elements
+ */
+#define rdl_init(rdl, t, i)        ({                                      \
+                                        (rdl)->type = (t);                  \
+                                        (rdl)->id = (i);                    \
+                                        rdl_init_head(rdl_head(rdl));       \
+                                    })
 /*
  * Add a rounded double-linked list element between two elements
  * Parameters:  p   - Previous element
@@ -83,10 +147,10 @@ typedef struct rdl {
  *              n   - Next element
  */
 #define rdl_add_elmt(p, e, n)      ({                                      \
-                                        (e)->prev = (p);                    \
-                                        (e)->next = (n);                    \
-                                        (p)->next = (e);                    \
-                                        (n)->prev = (e);                    \
+                                        rdl_set_prev((e), (p));             \
+                                        rdl_set_next((e), (n));             \
+                                        rdl_set_next((p), (e));             \
+                                        rdl_set_prev((n), (e));             \
                                     })
 
 /*
@@ -96,8 +160,8 @@ typedef struct rdl {
  *              n   - Next element
  */
 #define rdl_remove_elmt(p, e, n)   ({                                      \
-                                        (p)->next = (n);                    \
-                                        (n)->prev = (p);                    \
+                                        rdl_set_next((p), (n));             \
+                                        rdl_set_prev((n), (p));             \
                                     })
 
 /*
@@ -112,21 +176,60 @@ typedef struct rdl {
  *  Description: Add an element for a rounded double-linked list.
  *    Parameter: rdl  - Rounded double-linked list.
  *               elmt - Element to add.
+ *               st   - Counters to add contention to, or 0.
+ *               bo   - Backoff after a failed trylock, or 0.
  * Return value: On success returns RDL_RET_SUCCESS;
  *               on fail, it returns RDL_RET_FAIL.
  *               on error, it returns RDL_RET_ERROR.
  *
  */
-extern inline rdl_result rdl_add(rdl *rdl, rdl_element *elmt);
+extern rdl_result rdl_add(rdl *rdl, rdl_element *elmt, rdl_stats *st,
+        rdl_backoff *bo);
 
 /*
  *  Description: Remove an element from a rounded double-linked list
  *    Parameter: rdl  - Rounded double-linked list.
  *               elmt - Element removed.
+ *               st   - Counters to add contention to, or 0.
+ *               bo   - Backoff after a failed trylock, or 0.
+ * Return value: On success returns RDL_RET_SUCCESS;
+ *               on fail, it returns RDL_RET_FAIL.
+ *               on error, it returns RDL_RET_ERROR.
+ */
+extern rdl_result rdl_remove(rdl *rdl, rdl_element **elmt,
+        rdl_stats *st, rdl_backoff *bo);
+
+/*
+ *  Description: Add a chain of elements linked by next/prev for a rounded
+ *               double-linked list in one critical section.
+ *    Parameter: rdl   - Rounded double-linked list.
+ *               first - First element of chain.
+ *               last  - Last element of chain.
+ *               st    - Counters to add contention to, or 0.
+ *               bo    - Backoff after a failed trylock, or 0.
+ * Return value: On success returns RDL_RET_SUCCESS;
+ *               on fail, it returns RDL_RET_FAIL.
+ *               on error, it returns RDL_RET_ERROR.
+ */
+extern rdl_result rdl_add_n(rdl *rdl, rdl_element *first,
+        rdl_element *last, rdl_stats *st, rdl_backoff *bo);
+
+/*
+ *  Description: Remove a run of up to max adjacent elements from a rounded
+ *               double-linked list in one critical section. The removed
+ *               elements stay linked by next/prev from first to last.
+ *    Parameter: rdl   - Rounded double-linked list.
+ *               max   - Maximum number of elements to remove.
+ *               first - First element removed.
+ *               last  - Last element removed.
+ *               count - Number of elements removed.
+ *               st    - Counters to add contention to, or 0.
+ *               bo    - Backoff after a failed trylock, or 0.
  * Return value: On success returns RDL_RET_SUCCESS;
  *               on fail, it returns RDL_RET_FAIL.
  *               on error, it returns RDL_RET_ERROR.
  */
-extern inline rdl_result rdl_remove(rdl *rdl, rdl_element **elmt);
+extern rdl_result rdl_remove_n(rdl *rdl, int max, rdl_element **first,
+        rdl_element **last, int *count, rdl_stats *st, rdl_backoff *bo);
 
 #endif /* RDL_H_ */
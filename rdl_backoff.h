@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * rdl_backoff.h - Contention backoff for rounded double-linked list
+ *
+ *   Description: A thread losing a trylock or a whole operation backs off
+ *                before trying again, so that it does not keep pulling the
+ *                cache line of a lock held by another thread. Policies:
+ *                 none     - try again at once, as without backoff
+ *                 pause    - one spin-wait hint per failure
+ *                 exp      - spin-wait hints doubling per failure up to a
+ *                            limit, randomized to half of it at least so
+ *                            that threads failing together drift apart
+ *                 yield    - give up the CPU per failure
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#ifndef RDL_BACKOFF_H_
+#define RDL_BACKOFF_H_
+#include <sched.h>
+
+/*
+ * Policy of contention backoff
+ */
+typedef enum rdl_backoff_policy {
+    RDL_BACKOFF_NONE            = 0,
+    RDL_BACKOFF_PAUSE           = 1,
+    RDL_BACKOFF_EXP             = 2,
+    RDL_BACKOFF_YIELD           = 3
+} rdl_backoff_policy;
+
+/*
+ * Default limit of spin-wait hints of exponential backoff
+ */
+#define RDL_BACKOFF_LIMIT           1024
+
+/*
+ * State of contention backoff of one operation
+ */
+typedef struct rdl_backoff {
+    rdl_backoff_policy          policy;
+    unsigned int                limit;  // Most spin-wait hints at once
+    unsigned int                spins;  // Spin-wait hints of next failure
+    unsigned int                seed;   // Jitter of exponential backoff
+} rdl_backoff;
+
+/*
+ * Hint the CPU that the thread spin-waits
+ */
+static inline void rdl_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/*
+ *  Description: Initialize contention backoff.
+ *    Parameter: bo     - Backoff to initialize.
+ *               policy - Policy of backoff.
+ *               limit  - Most spin-wait hints at once, 0 for default.
+ */
+static inline void rdl_backoff_init(rdl_backoff *bo,
+        rdl_backoff_policy policy, unsigned int limit) {
+    bo->policy = policy;
+    bo->limit = limit ? limit : RDL_BACKOFF_LIMIT;
+    bo->spins = 1;
+    bo->seed = (unsigned int) (size_t) bo | 1;
+}
+
+/*
+ *  Description: Back off after a failure.
+ *    Parameter: bo     - Backoff, or 0 not to back off.
+ */
+static inline void rdl_backoff_wait(rdl_backoff *bo) {
+    unsigned int n;
+
+    if (0 == bo) {
+        return;
+    }
+
+    switch (bo->policy) {
+    case RDL_BACKOFF_PAUSE:
+        rdl_cpu_relax();
+        break;
+    case RDL_BACKOFF_EXP:
+        bo->seed ^= bo->seed << 13;
+        bo->seed ^= bo->seed >> 17;
+        bo->seed ^= bo->seed << 5;
+        n = bo->spins / 2 + bo->seed % (bo->spins / 2 + 1);
+        while (n-- > 0) {
+            rdl_cpu_relax();
+        }
+        if (bo->spins < bo->limit) {
+            bo->spins <<= 1;
+        }
+        break;
+    case RDL_BACKOFF_YIELD:
+        sched_yield();
+        break;
+    default:
+        break;
+    }
+}
+
+#endif /* RDL_BACKOFF_H_ */
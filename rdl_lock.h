@@ -1,6 +1,12 @@
 /*****************************************************************************
  * rdl_lock.h - Lock utilities for rounded double-linked list
  *
+ *   Description: Lock of an element is a byte of which bit 0 locks its next
+ *                link, bit 1 its previous link, and both together the whole
+ *                element. Taking a lock has acquire ordering and releasing
+ *                it release ordering, so that links written under a lock
+ *                are seen by the next holder, on any architecture with
+ *                lock-free byte atomics.
  *
  *    Created on: Oct 18, 2012
  *        Author: Kurt Zhi
@@ -10,6 +16,19 @@
 
 #ifndef RDL_LOCK_H_
 #define RDL_LOCK_H_
+#include <stdatomic.h>
+
+/*
+ * Lock of rounded double-linked list element
+ */
+typedef _Atomic char rdl_lock;
+
+/*
+ * Bits of lock
+ */
+#define RDL_LOCK_NEXT               0x01
+#define RDL_LOCK_PREV               0x02
+#define RDL_LOCK_ELMT               (RDL_LOCK_NEXT | RDL_LOCK_PREV)
 
 /*
  *  Description: Test and set rounded double-linked list element lock to
@@ -18,7 +37,11 @@
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_elmt(volatile char *lock);
+static inline int rdl_trylock_elmt(rdl_lock *lock) {
+    char orig = 0;
+    return atomic_compare_exchange_strong_explicit(lock, &orig, RDL_LOCK_ELMT,
+            memory_order_acquire, memory_order_relaxed) ? 0 : -1;
+}
 
 /*
  *  Description: Tries to test and set rounded double-linked list element lock
@@ -28,7 +51,16 @@ extern inline int rdl_trylock_elmt(volatile char *lock);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_elmt_n(volatile char *lock, int tries);
+static inline int rdl_trylock_elmt_n(rdl_lock *lock, int tries) {
+    int i = 0;
+    while (i < tries) {
+        if (0 == rdl_trylock_elmt(lock)) {
+            return 0;
+        }
+        i++;
+    }
+    return -1;
+}
 
 /*
  *  Description: Test and set rounded double-linked list element lock to
@@ -37,7 +69,27 @@ extern inline int rdl_trylock_elmt_n(volatile char *lock, int tries);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Unlock an already unlocked lock will returns -1.
  */
-extern inline int rdl_unlock_elmt(volatile char *lock);
+static inline int rdl_unlock_elmt(rdl_lock *lock) {
+    char orig = RDL_LOCK_ELMT;
+    return atomic_compare_exchange_strong_explicit(lock, &orig, 0,
+            memory_order_release, memory_order_relaxed) ? 0 : -1;
+}
+
+/*
+ * Set bit of lock, returns 0 if it was clear.
+ */
+static inline int rdl_trylock_bit(rdl_lock *lock, char bit) {
+    return atomic_fetch_or_explicit(lock, bit, memory_order_acquire) & bit
+            ? -1 : 0;
+}
+
+/*
+ * Clear bit of lock, returns 0 if it was set.
+ */
+static inline int rdl_unlock_bit(rdl_lock *lock, char bit) {
+    return atomic_fetch_and_explicit(lock, ~bit, memory_order_release) & bit
+            ? 0 : -1;
+}
 
 /*
  *  Description: Test and set rounded double-linked list next link lock to
@@ -46,7 +98,9 @@ extern inline int rdl_unlock_elmt(volatile char *lock);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_next(volatile char *lock);
+static inline int rdl_trylock_next(rdl_lock *lock) {
+    return rdl_trylock_bit(lock, RDL_LOCK_NEXT);
+}
 
 /*
  *  Description: Tries to test and set rounded double-linked list next link
@@ -56,7 +110,16 @@ extern inline int rdl_trylock_next(volatile char *lock);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_next_n(volatile char *lock, int tries);
+static inline int rdl_trylock_next_n(rdl_lock *lock, int tries) {
+    int i = 0;
+    while (i < tries) {
+        if (0 == rdl_trylock_next(lock)) {
+            return 0;
+        }
+        i++;
+    }
+    return -1;
+}
 
 /*
  *  Description: Test and set rounded double-linked list next link lock to
@@ -65,7 +128,9 @@ extern inline int rdl_trylock_next_n(volatile char *lock, int tries);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Unlock an already unlocked lock will returns -1.
  */
-extern inline int rdl_unlock_next(volatile char *lock);
+static inline int rdl_unlock_next(rdl_lock *lock) {
+    return rdl_unlock_bit(lock, RDL_LOCK_NEXT);
+}
 
 /*
  *  Description: Test and set rounded double-linked list previous link lock to
@@ -74,7 +139,9 @@ extern inline int rdl_unlock_next(volatile char *lock);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_prev(volatile char *lock);
+static inline int rdl_trylock_prev(rdl_lock *lock) {
+    return rdl_trylock_bit(lock, RDL_LOCK_PREV);
+}
 
 /*
  *  Description: Tries to test and set rounded double-linked list previous link
@@ -84,7 +151,16 @@ extern inline int rdl_trylock_prev(volatile char *lock);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Lock an already locked lock will returns -1.
  */
-extern inline int rdl_trylock_prev_n(volatile char *lock, int tries);
+static inline int rdl_trylock_prev_n(rdl_lock *lock, int tries) {
+    int i = 0;
+    while (i < tries) {
+        if (0 == rdl_trylock_prev(lock)) {
+            return 0;
+        }
+        i++;
+    }
+    return -1;
+}
 
 /*
  *  Description: Test and set rounded double-linked list previous link lock to
@@ -93,6 +169,8 @@ extern inline int rdl_trylock_prev_n(volatile char *lock, int tries);
  * Return value: On success returns 0; on error, it returns -1.
  *               Warning: Unlock an already unlocked lock will returns -1.
  */
-extern inline int rdl_unlock_prev(volatile char *lock);
+static inline int rdl_unlock_prev(rdl_lock *lock) {
+    return rdl_unlock_bit(lock, RDL_LOCK_PREV);
+}
 
 #endif /* RDL_LOCK_H_ */
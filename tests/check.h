@@ -0,0 +1,36 @@
+/*****************************************************************************
+ * check.h - Assertions of the tests run by make check
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#ifndef CHECK_H_
+#define CHECK_H_
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Fail the test, naming the condition that did not hold
+ * Parameters:  cond    - Condition to test
+ */
+#define CHECK(cond)                ({                                      \
+                                        if (!(cond)) {                      \
+                                            fprintf(stderr,                 \
+                                                    "%s:%d: %s failed\n",   \
+                                                    __FILE__, __LINE__,     \
+                                                    #cond);                 \
+                                            exit(1);                        \
+                                        }                                   \
+                                    })
+
+/*
+ * Milliseconds of CLOCK_MONOTONIC
+ */
+static inline long check_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+}
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,81 @@
+/*****************************************************************************
+ * test_keyed.c - Data of a key consumed in order, one at a time
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include "check.h"
+#include "paralexeclist.h"
+
+#define KEYS        16
+#define PER_KEY     2000
+#define CONSUMERS   4
+
+static paralexeclist_t list;
+static long last[KEYS];
+static int running[KEYS];
+static long consumed, disordered, overlapped;
+
+static void consume(void *data) {
+    long v = (intptr_t) data, key = v % KEYS, seq = v / KEYS;
+
+    if (__atomic_exchange_n(&(running[key]), 1, __ATOMIC_ACQ_REL)) {
+        __atomic_add_fetch(&overlapped, 1, __ATOMIC_RELAXED);
+    }
+    if (seq != last[key] + 1) {
+        __atomic_add_fetch(&disordered, 1, __ATOMIC_RELAXED);
+    }
+    last[key] = seq;
+    if (0 == seq % 7) {
+        sched_yield();
+    }
+    __atomic_store_n(&(running[key]), 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&consumed, 1, __ATOMIC_RELAXED);
+}
+
+static void *consumer(void *arg) {
+    while (__atomic_load_n(&consumed, __ATOMIC_RELAXED) < KEYS * PER_KEY) {
+        paralexeclist_consume_timed(list, 10);
+    }
+    return 0;
+}
+
+int main(void) {
+    pthread_t threads[CONSUMERS];
+    paralexeclist_attr attr;
+    size_t mem_len;
+    long i;
+
+    paralexeclist_attr_init(&attr);
+    attr.flags = PARALEXECLIST_ATTR_PARK;
+    attr.keys = 8;
+    attr.overflow = PARALEXECLIST_OVERFLOW_BLOCK;
+    attr.overflow_ms = -1;
+    CHECK(0 == paralexeclist_create_attr(&list, 64, consume, &attr,
+            &mem_len));
+    for (i = 0; i < KEYS; i++) {
+        last[i] = -1;
+    }
+    for (i = 0; i < CONSUMERS; i++) {
+        CHECK(0 == pthread_create(&(threads[i]), 0, consumer, 0));
+    }
+
+    for (i = 0; i < KEYS * PER_KEY; i++) {
+        CHECK(0 == paralexeclist_produce_keyed(list, i % KEYS,
+                (void *) (intptr_t) i));
+    }
+    for (i = 0; i < CONSUMERS; i++) {
+        CHECK(0 == pthread_join(threads[i], 0));
+    }
+
+    CHECK(KEYS * PER_KEY == consumed);
+    CHECK(0 == disordered && 0 == overlapped);
+    for (i = 0; i < KEYS; i++) {
+        CHECK(PER_KEY - 1 == last[i]);
+    }
+    paralexeclist_destroy(&list);
+    return 0;
+}
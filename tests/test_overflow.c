@@ -0,0 +1,169 @@
+/*****************************************************************************
+ * test_overflow.c - Overflow policies of producers finding idle empty
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "check.h"
+#include "paralexeclist.h"
+
+#define LIST_SIZE   4
+
+static long consumed[64], dropped[64];
+static int n_consumed, n_dropped;
+static volatile int holding, held;
+
+static void consume(void *data) {
+    consumed[n_consumed++] = (intptr_t) data;
+}
+
+static void overflowed(void *data) {
+    dropped[n_dropped++] = (intptr_t) data;
+}
+
+static void hold(void *data) {
+    held = 1;
+    while (holding) {
+        usleep(1000);
+    }
+}
+
+static void *consumer(void *arg) {
+    paralexeclist_consume((paralexeclist_t) arg);
+    return 0;
+}
+
+static paralexeclist_t create(int list_size, void (*routine)(void *),
+        int overflow, int overflow_ms) {
+    paralexeclist_attr attr;
+    paralexeclist_t list;
+    size_t mem_len;
+
+    paralexeclist_attr_init(&attr);
+    attr.flags = PARALEXECLIST_ATTR_PARK;
+    attr.overflow = overflow;
+    attr.overflow_ms = overflow_ms;
+    attr.overflow_routine = overflowed;
+    CHECK(0 == paralexeclist_create_attr(&list, list_size, routine, &attr,
+            &mem_len));
+    n_consumed = n_dropped = 0;
+    return list;
+}
+
+static void fill(paralexeclist_t list, long from) {
+    long i;
+    for (i = from; i < from + LIST_SIZE; i++) {
+        CHECK(0 == paralexeclist_produce(list, (void *) i));
+    }
+}
+
+static void drain(paralexeclist_t list) {
+    while (0 == paralexeclist_consume_timed(list, 0)) {
+    }
+}
+
+static void test_fail(void) {
+    paralexeclist_t list = create(LIST_SIZE, consume,
+            PARALEXECLIST_OVERFLOW_FAIL, -1);
+    void *more[] = {(void *) 5, (void *) 6};
+
+    fill(list, 1);
+    CHECK(PARALEXECLIST_RET_FULL == paralexeclist_produce(list, (void *) 5));
+    CHECK(0 == paralexeclist_produce_n(list, more, 2));
+    drain(list);
+    CHECK(LIST_SIZE == n_consumed && 1 == consumed[0] && 4 == consumed[3]);
+
+    // Batch stops where idle runs out
+    CHECK(2 == paralexeclist_produce_n(list, more, 2));
+    CHECK(2 == paralexeclist_produce_n(list, more, 2));
+    CHECK(0 == paralexeclist_produce_n(list, more, 2));
+    paralexeclist_destroy(&list);
+}
+
+static void test_block(void) {
+    paralexeclist_t list = create(LIST_SIZE, consume,
+            PARALEXECLIST_OVERFLOW_BLOCK, 50);
+    long start;
+
+    fill(list, 1);
+    start = check_now_ms();
+    CHECK(PARALEXECLIST_RET_TIMEOUT == paralexeclist_produce(list,
+            (void *) 5));
+    CHECK(check_now_ms() - start >= 40);
+
+    // Per-call override of the policy
+    CHECK(PARALEXECLIST_RET_FULL == paralexeclist_produce_ex(list,
+            (void *) 5, 0, PARALEXECLIST_OVERFLOW_FAIL, 0));
+    paralexeclist_destroy(&list);
+}
+
+static void test_drop_oldest(void) {
+    paralexeclist_t list = create(LIST_SIZE, consume,
+            PARALEXECLIST_OVERFLOW_DROP_OLDEST, -1);
+    void *more[] = {(void *) 7, (void *) 8, (void *) 9, (void *) 10,
+            (void *) 11, (void *) 12};
+
+    fill(list, 1);
+    CHECK(0 == paralexeclist_produce(list, (void *) 5));
+    CHECK(0 == paralexeclist_produce(list, (void *) 6));
+    CHECK(2 == n_dropped && 1 == dropped[0] && 2 == dropped[1]);
+
+    CHECK(6 == paralexeclist_produce_n(list, more, 6));
+    CHECK(8 == n_dropped && 8 == dropped[7]);
+    drain(list);
+    CHECK(LIST_SIZE == n_consumed && 9 == consumed[0] && 12 == consumed[3]);
+    paralexeclist_destroy(&list);
+}
+
+static void test_drop_oldest_held(void) {
+    paralexeclist_t list = create(1, hold,
+            PARALEXECLIST_OVERFLOW_DROP_OLDEST, 50);
+    pthread_t thread;
+    long start;
+
+    // The consumer holds the only element, nothing is left to drop
+    holding = 1;
+    held = 0;
+    CHECK(0 == paralexeclist_produce(list, (void *) 1));
+    CHECK(0 == pthread_create(&thread, 0, consumer, list));
+    while (!held) {
+        usleep(1000);
+    }
+    start = check_now_ms();
+    CHECK(PARALEXECLIST_RET_TIMEOUT == paralexeclist_produce(list,
+            (void *) 2));
+    CHECK(check_now_ms() - start >= 40 && 0 == n_dropped);
+
+    holding = 0;
+    CHECK(0 == pthread_join(thread, 0));
+    CHECK(0 == paralexeclist_produce(list, (void *) 3));
+    paralexeclist_destroy(&list);
+}
+
+static void test_divert(void) {
+    paralexeclist_t list = create(LIST_SIZE, consume,
+            PARALEXECLIST_OVERFLOW_FAIL, -1);
+    void *more[] = {(void *) 6, (void *) 7, (void *) 8};
+
+    fill(list, 1);
+    CHECK(0 == paralexeclist_produce_ex(list, (void *) 5, 0,
+            PARALEXECLIST_OVERFLOW_DIVERT, 0));
+    CHECK(3 == paralexeclist_produce_n_ex(list, more, 3,
+            PARALEXECLIST_OVERFLOW_DIVERT, 0));
+    CHECK(4 == n_dropped && 5 == dropped[0] && 8 == dropped[3]);
+    drain(list);
+    CHECK(LIST_SIZE == n_consumed);
+    paralexeclist_destroy(&list);
+}
+
+int main(void) {
+    test_fail();
+    test_block();
+    test_drop_oldest();
+    test_drop_oldest_held();
+    test_divert();
+    return 0;
+}
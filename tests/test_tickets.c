@@ -0,0 +1,121 @@
+/*****************************************************************************
+ * test_tickets.c - Lifecycle of tickets, each spent once
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <stdint.h>
+#include "check.h"
+#include "paralexeclist.h"
+
+#define LIST_SIZE   4
+
+static void square(void *data) {
+    long v = (intptr_t) data;
+    paralexeclist_set_result(v * v);
+}
+
+static paralexeclist_t create(int flags, int max_size) {
+    paralexeclist_attr attr;
+    paralexeclist_t list;
+    size_t mem_len;
+
+    paralexeclist_attr_init(&attr);
+    attr.flags = flags;
+    attr.max_size = max_size;
+    CHECK(0 == paralexeclist_create_attr(&list, LIST_SIZE, square, &attr,
+            &mem_len));
+    return list;
+}
+
+static void test_lifecycle(void) {
+    paralexeclist_t list = create(PARALEXECLIST_ATTR_TICKETS, 0);
+    paralexeclist_ticket tickets[LIST_SIZE];
+    long results[LIST_SIZE];
+    long i;
+
+    for (i = 0; i < LIST_SIZE; i++) {
+        CHECK(0 == paralexeclist_produce_ticket(list, (void *) (i + 1),
+                &(tickets[i])));
+    }
+    CHECK(PARALEXECLIST_RET_TIMEOUT == paralexeclist_wait(list, tickets[0],
+            results, 0));
+    while (0 == paralexeclist_consume_timed(list, 0)) {
+    }
+    CHECK(0 == paralexeclist_wait_all(list, tickets, LIST_SIZE, results, 0));
+    CHECK(1 == results[0] && 16 == results[3]);
+
+    // Elements went back to idle, and tickets on them differ
+    for (i = 0; i < LIST_SIZE; i++) {
+        paralexeclist_ticket old = tickets[i];
+        CHECK(0 == paralexeclist_produce_ticket(list, (void *) (i + 5),
+                &(tickets[i])));
+        CHECK(old != tickets[i]);
+    }
+    while (0 == paralexeclist_consume_timed(list, 0)) {
+    }
+    CHECK(0 == paralexeclist_wait_all(list, tickets, LIST_SIZE, results, -1));
+    CHECK(25 == results[0] && 64 == results[3]);
+    paralexeclist_destroy(&list);
+}
+
+static void test_double_spend(void) {
+    paralexeclist_t list = create(PARALEXECLIST_ATTR_TICKETS, 0);
+    paralexeclist_ticket ticket, twice[2], other;
+    long result;
+
+    CHECK(0 == paralexeclist_produce_ticket(list, (void *) 3, &ticket));
+    CHECK(0 == paralexeclist_consume_timed(list, 0));
+    CHECK(0 == paralexeclist_wait(list, ticket, &result, 0));
+    CHECK(9 == result);
+    CHECK(-1 == paralexeclist_wait(list, ticket, &result, 0));
+
+    // A stale ticket does not spend the next one of its element
+    CHECK(0 == paralexeclist_produce_ticket(list, (void *) 4, &other));
+    CHECK(0 == paralexeclist_consume_timed(list, 0));
+    CHECK(-1 == paralexeclist_wait(list, ticket, &result, 0));
+    twice[0] = twice[1] = other;
+    CHECK(-1 == paralexeclist_wait_all(list, twice, 2, 0, 0));
+    CHECK(-1 == paralexeclist_wait(list, other, &result, 0));
+
+    // Every element is back in idle
+    for (int i = 0; i < LIST_SIZE; i++) {
+        CHECK(0 == paralexeclist_produce_ticket(list, (void *) 1, &ticket));
+    }
+    paralexeclist_destroy(&list);
+}
+
+static void test_bogus(void) {
+    paralexeclist_t list = create(PARALEXECLIST_ATTR_TICKETS,
+            4 * LIST_SIZE);
+    paralexeclist_t plain = create(0, 0);
+    paralexeclist_ticket tickets[2 * LIST_SIZE];
+    long results[2 * LIST_SIZE];
+    long i;
+
+    CHECK(-1 == paralexeclist_wait(list, 12345UL << 32 | 1000000, 0, 0));
+    CHECK(-1 == paralexeclist_wait(list, 12345UL << 32 | 1, 0, 0));
+    CHECK(-1 == paralexeclist_wait(plain, 8UL << 32 | 1, 0, 0));
+    CHECK(-1 == paralexeclist_wait_all(plain, tickets, 0, 0, 0));
+
+    // Tickets on elements of an elastic segment
+    for (i = 0; i < 2 * LIST_SIZE; i++) {
+        CHECK(0 == paralexeclist_produce_ticket(list, (void *) i,
+                &(tickets[i])));
+    }
+    while (0 == paralexeclist_consume_timed(list, 0)) {
+    }
+    CHECK(0 == paralexeclist_wait_all(list, tickets, 2 * LIST_SIZE, results,
+            0));
+    CHECK(49 == results[7]);
+    CHECK(-1 == paralexeclist_wait(list, tickets[7], 0, 0));
+    paralexeclist_destroy(&plain);
+    paralexeclist_destroy(&list);
+}
+
+int main(void) {
+    test_lifecycle();
+    test_double_spend();
+    test_bogus();
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * test_timers.c - Data scheduled by paralexeclist_produce_at enrolled once
+ *                 their deadline passed, and not before
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <stdint.h>
+#include "check.h"
+#include "paralexeclist.h"
+
+#define TIMERS      8
+
+static long fired[TIMERS];
+static int n_fired;
+
+static void consume(void *data) {
+    fired[(intptr_t) data] = check_now_ms();
+    n_fired++;
+}
+
+static struct timespec after_ms(long ms) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += ms % 1000 * 1000000L;
+    if (t.tv_nsec >= 1000000000L) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+    return t;
+}
+
+int main(void) {
+    paralexeclist_attr attr;
+    paralexeclist_t list, plain;
+    struct timespec deadline;
+    long start, i;
+    size_t mem_len;
+
+    paralexeclist_attr_init(&attr);
+    attr.flags = PARALEXECLIST_ATTR_TIMERS;
+    CHECK(0 == paralexeclist_create_attr(&list, TIMERS, consume, &attr,
+            &mem_len));
+
+    // Scheduled in reverse, from 160 ms down to 20 ms
+    start = check_now_ms();
+    for (i = 0; i < TIMERS; i++) {
+        deadline = after_ms((TIMERS - i) * 20);
+        CHECK(0 == paralexeclist_produce_at(list, (void *) (intptr_t) i,
+                &deadline));
+    }
+    CHECK(PARALEXECLIST_RET_EMPTY == paralexeclist_consume_timed(list, 0));
+    while (n_fired < TIMERS && check_now_ms() - start < 2000) {
+        paralexeclist_consume_timed(list, 50);
+    }
+    CHECK(TIMERS == n_fired);
+    for (i = 0; i < TIMERS; i++) {
+        CHECK(fired[i] - start >= (TIMERS - i) * 20 - 1);
+        CHECK(0 == i || fired[i] <= fired[i - 1]);
+    }
+
+    // A deadline passed, the last one above, enrolls data at once
+    CHECK(0 == paralexeclist_produce_at(list, (void *) 0, &deadline));
+    CHECK(0 == paralexeclist_consume_timed(list, 0));
+    CHECK(TIMERS + 1 == n_fired);
+    paralexeclist_destroy(&list);
+
+    paralexeclist_attr_init(&attr);
+    CHECK(0 == paralexeclist_create_attr(&plain, TIMERS, consume, &attr,
+            &mem_len));
+    CHECK(-1 == paralexeclist_produce_at(plain, (void *) 0, &deadline));
+    paralexeclist_destroy(&plain);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*****************************************************************************
+ * test_wrapper.cpp - Typed list of paralexeclist.hpp, where a throwing Fn
+ *                    loses only its own T
+ *
+ *    Created on: Oct 17, 2026
+ *****************************************************************************/
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "paralexeclist.hpp"
+
+static long live, consumed, sum;
+
+struct Item {
+    std::string s;
+
+    explicit Item(long v) : s(std::to_string(v)) {
+        live++;
+    }
+
+    Item(Item &&other) noexcept : s(std::move(other.s)) {
+        live++;
+    }
+
+    ~Item() {
+        live--;
+    }
+};
+
+static void add(Item &&item) noexcept {
+    sum += std::stol(item.s);
+    consumed++;
+}
+
+static void refuse_two(Item &&item) {
+    if ("2" == item.s) {
+        throw std::runtime_error(item.s);
+    }
+    consumed++;
+}
+
+static void test_consume() {
+    std::vector<Item> items;
+    long i;
+
+    {
+        ParalExecList<Item, add> list(16);
+        for (i = 1; i <= 8; i++) {
+            CHECK(0 == list.emplace(i));
+        }
+        for (i = 9; i <= 12; i++) {
+            items.emplace_back(i);
+        }
+        CHECK(0 == list.produce_n(items.begin(), items.end()));
+        CHECK(12 == list.consume_n(32, 0));
+        CHECK(78 == sum && 12 == consumed);
+
+        // Left enrolled, destroyed with the list without running Fn
+        CHECK(0 == list.emplace(13));
+    }
+    CHECK(12 == consumed && 4 == live);
+    items.clear();
+    CHECK(0 == live);
+}
+
+static void test_throw() {
+    bool threw = false;
+    int i;
+
+    consumed = 0;
+    {
+        ParalExecList<Item, refuse_two> list(16);
+        for (i = 0; i < 5; i++) {
+            CHECK(0 == list.emplace(i));
+        }
+        try {
+            list.consume_n(5, 0);
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        CHECK(threw && 2 == consumed && 2 == live);
+        CHECK(2 == list.consume_n(5, 0));
+        CHECK(4 == consumed && 0 == live);
+        CHECK(0 == list.consume_n(5, 0));
+
+        // Elements of the lost T went back to idle
+        for (i = 0; i < 16; i++) {
+            CHECK(0 == list.emplace(10));
+        }
+        CHECK(16 == list.consume_n(16, 0));
+    }
+    CHECK(0 == live);
+}
+
+static void test_attr() {
+    paralexeclist_attr attr;
+    bool threw = false;
+
+    paralexeclist_attr_init(&attr);
+    attr.keys = 2;
+    try {
+        ParalExecList<Item, add> list(8, &attr);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+int main() {
+    test_consume();
+    test_throw();
+    test_attr();
+    return 0;
+}